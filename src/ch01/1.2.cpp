@@ -6,6 +6,7 @@
  * @Description  : 测试 C++20 的格式化输出，GCC 和 Clang 尚未实现，可以使用第三方库 fmt
  */
 
+#include <algorithm>
 #include <cstdio>
 #include <format>
 #include <iostream>
@@ -13,18 +14,75 @@
 #include <string>
 #include <string_view>
 
+#include "ez/bench.h"
+#include "ez/outbuf.h"
+
 using std::cout;
 using std::format;
 using std::string;
 
+// 格式串在运行期传入，每次调用都要解析，实参经过类型擦除
 template <typename... Args>
-void print(const std::string_view fmt_str, Args &&...args) {
+void vprint(const std::string_view fmt_str, Args &&...args) {
     auto fmt_args{std::make_format_args(args...)};
     string outstr{vformat(fmt_str, fmt_args)};
     fputs(outstr.c_str(), stdout);
 }
 
-auto main() -> int {
+// 格式串在编译期检查，先格式化到栈上的缓冲，放不下时才分配
+template <typename... Args>
+void print(std::format_string<Args...> fmt, Args &&...args) {
+    char tmp[256];
+    const auto r{std::format_to_n(tmp, sizeof(tmp), fmt, std::forward<Args>(args)...)};
+    if (static_cast<size_t>(r.size) <= sizeof(tmp)) {
+        std::fwrite(tmp, 1, static_cast<size_t>(r.size), stdout);
+    } else {
+        const string s{format(fmt, std::forward<Args>(args)...)};
+        std::fwrite(s.data(), 1, s.size(), stdout);
+    }
+}
+
+// 每种输出方式对 int、double、string 各输出 n 次，报告写到 stderr
+// 格式化结果写到 stdout，需要 JSON 时用 --json=file：0102 --bench 100000 --json=1.2.json > /dev/null
+void bench(ez::bench::Runner &runner) {
+    const size_t n{std::max<size_t>(1, runner.count(0, 100'000))};
+    auto run = [&](std::string_view name, auto &&f) {
+        runner.run(format("1.2/{}", name), n, [&] {
+            for (size_t i{}; i < n; ++i) { f(i); }
+            ez::out().flush();
+            cout.flush();
+            return std::fflush(stdout);
+        });
+    };
+    const string who{"everyone"};
+    const double pi{std::numbers::pi};
+    auto &out{ez::out()};
+
+    auto each = [&](std::string_view type, auto value) {
+        run(format("{:<6} cout << format", type), [&](size_t) { cout << format("{} ", value); });
+        run(format("{:<6} vprint", type), [&](size_t) { vprint("{} ", value); });
+        run(format("{:<6} print", type), [&](size_t) { print("{} ", value); });
+        run(format("{:<6} OutBuf::print", type), [&](size_t) { out.print("{} ", value); });
+        run(format("{:<6} OutBuf::put<{{}} >", type), [&](size_t) { out.put<"{} ">(value); });
+    };
+    each("int", 123'456'789);
+    each("double", pi);
+    each("string", who);
+
+    run("pair   OutBuf::print", [&](size_t i) { out.print("{}:{}\n", i, who); });
+    run("pair   OutBuf::put<{}:{}\\n>", [&](size_t i) { out.put<"{}:{}\n">(i, who); });
+    run("line   OutBuf::print", [&](size_t i) { out.print("{}: {} {}\n", i, who, pi); });
+    run("line   OutBuf::print_n", [&](size_t i) { out.print_n("{}: {} {}\n", i, who, pi); });
+    run("line   OutBuf::put", [&](size_t i) { out.put<"{}: {} {}\n">(i, who, pi); });
+}
+
+auto main(int argc, char *argv[]) -> int {
+    if (ez::bench::requested(argc, argv)) {
+        ez::bench::Runner runner{argc, argv};
+        bench(runner);
+        return 0;
+    }
+
     string who{"everyone"};
     int ival{42};
     double pi{std::numbers::pi};
@@ -46,4 +104,14 @@ auto main() -> int {
     print("Hello {1} {0}\n", ival, who);
     print("{:.^10}\n", ival);
     print("{:.5}\n", pi);
+    // print("{:d}\n", who); // 编译期报错：string 不支持 d
+
+    const string fmt_str{"{} and {}\n"};
+    vprint(fmt_str, ival, who); // 运行期才确定的格式串
+
+    auto &out{ez::out()};
+    out.put<"{}:{}\n">(ival, who); // 42:everyone
+    out.put<"{} ">(pi);
+    out.put<"{:.5}\n">(pi); // 带格式说明时退回 std::format
+    out.flush();
 }
@@ -6,10 +6,15 @@
  * @Description  : 使用编译时 vector 和字符串
  */
 
+#include <format>
 #include <iostream>
 #include <string>
+#include <string_view>
 #include <vector>
 
+#include "ez/alloc_counter.h"
+#include "ez/small_vector.h"
+
 using std::string;
 
 constexpr auto use_vector() {
@@ -17,6 +22,84 @@ constexpr auto use_vector() {
     return vec;
 }
 
+// 元素在对象内部，可以作为常量返回
+constexpr auto use_static_vector() {
+    ez::static_vector<int, 8> vec{1, 2, 3, 4, 5};
+    return vec;
+}
+
+constexpr auto use_small_vector() {
+    ez::small_vector<int, 8> vec{1, 2, 3, 4, 5};
+    return vec;
+}
+
+// 常量求值中溢出到堆也可以，只是结果不能保留到运行期
+constexpr auto spilled_sum() {
+    ez::small_vector<int, 2> vec{};
+    for (int i{1}; i <= 10; ++i) { vec.push_back(i); }
+    int sum{};
+    for (const int v : vec) { sum += v; }
+    return sum;
+}
+
+// 内部存储已满时压入自己的元素：参数引用的元素在溢出时会被移走，必须先构造新元素
+constexpr auto self_push() {
+    ez::small_vector<std::string, 2> vec{"alpha", "bravo"};
+    vec.push_back(vec[0]);
+    vec.emplace_back(vec[1]);
+    return vec.size() == 4 && vec[0] == "alpha" && vec[2] == "alpha" && vec[3] == "bravo";
+}
+
+// 移动溢出后的 vector，源对象应为空且可以继续使用
+constexpr auto move_spilled() {
+    ez::small_vector<int, 2> a{1, 2, 3};
+    ez::small_vector<int, 2> b{std::move(a)};
+    const bool moved{a.empty() && a.is_inline() && a.begin() == a.end() && b.size() == 3 && b[2] == 3};
+    a.push_back(4);
+    ez::small_vector<int, 2> c{};
+    c = std::move(b);
+    return moved && b.empty() && b.is_inline() && c.size() == 3 && a.size() == 1 && a[0] == 4;
+}
+
+// 以空格分隔的记号，与单词计数中的切分相同
+template <typename V>
+constexpr auto split(std::string_view s) -> V {
+    V tokens{};
+    while (!s.empty()) {
+        const auto b{s.find_first_not_of(' ')};
+        if (b == std::string_view::npos) { break; }
+        s.remove_prefix(b);
+        const auto token{s.substr(0, s.find(' '))};
+        tokens.push_back(token);
+        s.remove_prefix(token.size());
+    }
+    return tokens;
+}
+
+constexpr auto vec = use_static_vector();
+constexpr auto small = use_small_vector();
+static_assert(vec.size() == 5 && vec[0] == 1 && vec.back() == 5);
+static_assert(small.is_inline() && small.size() == 5 && small[4] == 5);
+static_assert(spilled_sum() == 55);
+static_assert(self_push());
+static_assert(move_spilled());
+static_assert(split<ez::static_vector<std::string_view, 4>>("  9 6  * ").size() == 3);
+static_assert(split<ez::small_vector<std::string_view, 2>>("a b c d e").back() == "e");
+
+// 重复构建 n 个小 vector，统计堆分配次数
+template <typename V>
+void count_allocs(std::string_view name, size_t n) {
+    const ez::alloc::Scope scope{};
+    size_t sink{};
+    for (size_t i{}; i < n; ++i) {
+        V v{};
+        v.push_back(static_cast<int>(i));
+        v.push_back(static_cast<int>(i + 1));
+        sink += v.size();
+    }
+    std::cout << std::format("{:<28} {:>9} allocations for {} pairs\n", name, scope.allocations(), sink / 2);
+}
+
 auto main() -> int {
 
     // 报错：表达式的计算结果不是常数，(子) 对象指向在常量计算过程中堆分配的内存
@@ -24,5 +107,33 @@ auto main() -> int {
     // std::cout << vec[0];
 
     constexpr auto value = use_vector().size();
-    std::cout << value;
+    std::cout << value << "\n";
+
+    std::cout << std::format("static_vector: {} {} {} {} {}\n", vec[0], vec[1], vec[2], vec[3], vec[4]);
+
+    constexpr size_t n{1'000'000};
+    count_allocs<std::vector<int>>("std::vector<int>", n);
+    count_allocs<ez::small_vector<int, 4>>("ez::small_vector<int, 4>", n);
+    count_allocs<ez::static_vector<int, 4>>("ez::static_vector<int, 4>", n);
+
+    {
+        const ez::alloc::Scope scope{};
+        const auto tokens{split<std::vector<std::string_view>>("9 6 * 2 3 * +")};
+        std::cout << std::format("split into std::vector: {} tokens, {} allocations\n", tokens.size(), scope.allocations());
+    }
+    {
+        const ez::alloc::Scope scope{};
+        const auto tokens{split<ez::small_vector<std::string_view, 8>>("9 6 * 2 3 * +")};
+        std::cout << std::format("split into small_vector: {} tokens, {} allocations\n", tokens.size(), scope.allocations());
+    }
+    {
+        // 超过 N 时才分配：从内部存储移到堆上一次，之后按 std::vector 的方式增长
+        const ez::alloc::Scope scope{};
+        ez::small_vector<int, 4> v{};
+        for (int i{}; i < 4; ++i) { v.push_back(i); }
+        const size_t before{scope.allocations()};
+        for (int i{4}; i < 100; ++i) { v.push_back(i); }
+        std::cout << std::format("small_vector<int, 4>: {} allocations for 4 elements, {} for 100\n", before,
+                                 scope.allocations());
+    }
 }
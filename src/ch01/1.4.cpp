@@ -6,16 +6,205 @@
  * @Description  : 安全地比较不同类型的整数
  */
 
+#include <algorithm>
+#include <concepts>
+#include <cstdint>
 #include <cstdio>
+#include <format>
 #include <iostream>
+#include <limits>
+#include <random>
+#include <span>
 #include <string>
+#include <string_view>
+#include <type_traits>
 #include <utility>
+#include <vector>
+
+#include "ez/bench.h"
 
 // using std::cout;
 // using std::endl;
 using std::string;
 
-auto main() -> int {
+namespace ez {
+    // 与 std::cmp_less 结果相同，但不含分支：有符号数为负时直接得出结果，否则按无符号数比较
+    // 两个条件用 | 和 & 组合而不是 || 和 &&，循环中可以被编译器向量化
+    template <std::integral T, std::integral U>
+    constexpr auto cmp_less(T t, U u) noexcept -> bool {
+        if constexpr (std::is_signed_v<T> == std::is_signed_v<U>) {
+            return t < u;
+        } else if constexpr (std::is_signed_v<T>) {
+            return (t < 0) | (static_cast<std::make_unsigned_t<T>>(t) < u);
+        } else {
+            return (u >= 0) & (t < static_cast<std::make_unsigned_t<U>>(u));
+        }
+    }
+
+    // 小于 bound 的元素个数；块内用 32 位计数，与元素等宽的计数更容易向量化
+    template <std::integral T, std::integral U>
+    auto count_cmp_less(std::span<const T> v, U bound) -> size_t {
+        constexpr size_t block{1 << 16};
+        size_t n{};
+        for (size_t i{}; i < v.size(); i += block) {
+            const size_t end{std::min(v.size(), i + block)};
+            uint32_t k{};
+            for (size_t j{i}; j < end; ++j) { k += static_cast<uint32_t>(cmp_less(v[j], bound)); }
+            n += k;
+        }
+        return n;
+    }
+
+    // 全部元素都在 [lo, hi] 内；按块检查，块内不提前退出以便向量化
+    template <std::integral T, std::integral L, std::integral H>
+    auto all_in_range(std::span<const T> v, L lo, H hi) -> bool {
+        constexpr size_t block{1024};
+        for (size_t i{}; i < v.size(); i += block) {
+            const size_t end{std::min(v.size(), i + block)};
+            uint32_t bad{};
+            for (size_t j{i}; j < end; ++j) {
+                bad += static_cast<uint32_t>(cmp_less(v[j], lo) | cmp_less(hi, v[j]));
+            }
+            if (bad != 0) { return false; }
+        }
+        return true;
+    }
+
+    // 与 std::in_range<R> 相同，检查全部元素都能用 R 表示
+    template <std::integral R, std::integral T>
+    auto all_in_range(std::span<const T> v) -> bool {
+        return all_in_range(v, std::numeric_limits<R>::min(), std::numeric_limits<R>::max());
+    }
+
+    // 将 in 转换为 R 写入 out，超出 [lo, hi] 的值饱和到边界，比较遵循 cmp_* 的语义
+    template <std::integral T, std::integral R>
+    void safe_clamp(std::span<const T> in, std::span<R> out, R lo = std::numeric_limits<R>::min(),
+                    R hi = std::numeric_limits<R>::max()) {
+        const size_t n{std::min(in.size(), out.size())};
+        for (size_t i{}; i < n; ++i) {
+            const T e{in[i]};
+            const R r{static_cast<R>(e)};
+            out[i] = cmp_less(e, lo) ? lo : cmp_less(hi, e) ? hi : r;
+        }
+    }
+} // namespace ez
+
+constexpr int int_min{std::numeric_limits<int>::min()};
+constexpr unsigned uint_max{std::numeric_limits<unsigned>::max()};
+static_assert(ez::cmp_less(-1, 0U) && !ez::cmp_less(0U, -1));
+static_assert(ez::cmp_less(int_min, 0U) && ez::cmp_less(int_min, uint_max));
+static_assert(!ez::cmp_less(uint_max, int_min) && !ez::cmp_less(uint_max, -1));
+static_assert(ez::cmp_less(-1, uint64_t{0}) && ez::cmp_less(uint_max, int64_t{1} << 32));
+static_assert(!ez::cmp_less(std::numeric_limits<uint64_t>::max(), std::numeric_limits<int64_t>::max()));
+
+// 逐个元素使用 std::cmp_* 的参考实现
+namespace ref {
+    template <typename T, typename U>
+    auto count_cmp_less(std::span<const T> v, U bound) -> size_t {
+        size_t n{};
+        for (const T e : v) {
+            if (std::cmp_less(e, bound)) { ++n; }
+        }
+        return n;
+    }
+
+    template <typename T, typename L, typename H>
+    auto all_in_range(std::span<const T> v, L lo, H hi) -> bool {
+        return std::ranges::all_of(v, [&](T e) { return std::cmp_less_equal(lo, e) && std::cmp_less_equal(e, hi); });
+    }
+
+    template <typename T, typename R>
+    void safe_clamp(std::span<const T> in, std::span<R> out, R lo, R hi) {
+        for (size_t i{}; i < in.size(); ++i) {
+            if (std::cmp_less(in[i], lo)) {
+                out[i] = lo;
+            } else if (std::cmp_greater(in[i], hi)) {
+                out[i] = hi;
+            } else {
+                out[i] = static_cast<R>(in[i]);
+            }
+        }
+    }
+} // namespace ref
+
+// 每种类型的边界值：最小值、最大值及其相邻值、-1、0、1
+template <std::integral T>
+auto edges() -> std::vector<T> {
+    using lim = std::numeric_limits<T>;
+    std::vector<T> v{lim::min(), static_cast<T>(lim::min() + 1), 0, 1, static_cast<T>(lim::max() - 1), lim::max()};
+    if constexpr (std::is_signed_v<T>) { v.push_back(-1); }
+    return v;
+}
+
+// 值取 T 的边界值，界限取 U 的边界值，逐对比较；8 位类型穷举全部取值
+template <std::integral T, std::integral U>
+auto check(std::string_view name) -> bool {
+    std::vector<T> values{edges<T>()};
+    std::vector<U> bounds{edges<U>()};
+    if constexpr (sizeof(T) == 1 && sizeof(U) == 1) {
+        values.clear();
+        bounds.clear();
+        for (int i{std::numeric_limits<T>::min()}; i <= std::numeric_limits<T>::max(); ++i) { values.push_back(static_cast<T>(i)); }
+        for (int i{std::numeric_limits<U>::min()}; i <= std::numeric_limits<U>::max(); ++i) { bounds.push_back(static_cast<U>(i)); }
+    }
+
+    bool ok{true};
+    std::vector<U> out(values.size());
+    std::vector<U> expected(values.size());
+    for (const U b : bounds) {
+        for (const T v : values) {
+            ok = ok && ez::cmp_less(v, b) == std::cmp_less(v, b) && ez::cmp_less(b, v) == std::cmp_less(b, v);
+        }
+        ok = ok && ez::count_cmp_less<T>(values, b) == ref::count_cmp_less<T>(values, b);
+        for (const U c : bounds) {
+            const U lo{std::min(b, c)};
+            const U hi{std::max(b, c)};
+            ok = ok && ez::all_in_range<T>(values, lo, hi) == ref::all_in_range<T>(values, lo, hi);
+            ez::safe_clamp<T, U>(values, out, lo, hi);
+            ref::safe_clamp<T, U>(values, expected, lo, hi);
+            ok = ok && out == expected;
+        }
+    }
+    std::cout << std::format("{:<18} {}\n", name, ok ? "ok" : "MISMATCH");
+    return ok;
+}
+
+// 随机的有符号 ID 与无符号上限比较，对比逐个元素调用 std::cmp_less
+void bench(ez::bench::Runner &runner) {
+    const size_t n{runner.count(0, 1 << 22)};
+    std::mt19937 rng{42};
+    // 上限取 [1, INT_MAX]：0 会使 rng() % limit 除以零，超过 INT_MAX 时 valid 中的值转换为 int 后为负数
+    const unsigned limit{static_cast<unsigned>(std::clamp<size_t>(runner.count(1, 1U << 30), 1, std::numeric_limits<int>::max()))};
+    std::vector<int> ids(n);
+    std::vector<int> valid(n); // 全部在 [0, limit] 内，all_in_range 需要检查到最后
+    for (size_t i{}; i < n; ++i) {
+        ids[i] = static_cast<int>(rng());
+        valid[i] = static_cast<int>(rng() % limit);
+    }
+    const std::span<const int> v{ids};
+    std::vector<unsigned> out(n);
+
+    runner.run("1.4/count_cmp_less/std", n, [&] { return ref::count_cmp_less(v, limit); });
+    runner.run("1.4/count_cmp_less/ez", n, [&] { return ez::count_cmp_less(v, limit); });
+    runner.run("1.4/all_in_range/std", n, [&] { return ref::all_in_range<int>(valid, 0, limit); });
+    runner.run("1.4/all_in_range/ez", n, [&] { return ez::all_in_range<int>(valid, 0, limit); });
+    runner.run("1.4/safe_clamp/std", n, [&] {
+        ref::safe_clamp<int, unsigned>(v, out, 0, limit);
+        return out[0];
+    });
+    runner.run("1.4/safe_clamp/ez", n, [&] {
+        ez::safe_clamp<int, unsigned>(v, out, 0, limit);
+        return out[0];
+    });
+}
+
+auto main(int argc, char *argv[]) -> int {
+    if (ez::bench::requested(argc, argv)) {
+        ez::bench::Runner runner{argc, argv};
+        bench(runner);
+        return 0;
+    }
+
     int x{-3};
     unsigned y{7};
 
@@ -37,4 +226,22 @@ auto main() -> int {
     std::cout << std::cmp_less_equal(x, y);    // x <= y is true
     std::cout << std::cmp_greater(x, y);       // x > y is false
     std::cout << std::cmp_greater_equal(x, y); // x >= y is false
+    std::cout << "\n";
+
+    const std::vector<int> ids{-5, 0, 7, int_min, 42};
+    std::cout << std::format("{} ids < 7U\n", ez::count_cmp_less<int>(ids, 7U)); // 3
+    std::cout << std::format("all in unsigned: {}\n", ez::all_in_range<unsigned, int>(ids)); // false
+    std::vector<unsigned> clamped(ids.size());
+    ez::safe_clamp<int, unsigned>(ids, clamped); // 负数饱和为 0
+    std::cout << std::format("{} {} {} {} {}\n", clamped[0], clamped[1], clamped[2], clamped[3], clamped[4]);
+
+    bool ok{check<int8_t, uint8_t>("int8 / uint8")};
+    ok = check<uint8_t, int8_t>("uint8 / int8") && ok;
+    ok = check<int, unsigned>("int / unsigned") && ok;
+    ok = check<unsigned, int>("unsigned / int") && ok;
+    ok = check<int, uint64_t>("int / uint64") && ok;
+    ok = check<unsigned, int64_t>("unsigned / int64") && ok;
+    ok = check<int64_t, uint64_t>("int64 / uint64") && ok;
+    ok = check<uint64_t, int16_t>("uint64 / int16") && ok;
+    return ok ? 0 : 1;
 }
@@ -6,10 +6,41 @@
  * @Description  : concept and constraint
  */
 
+#include <algorithm>
+#include <cmath>
 #include <concepts>
+#include <cstdint>
+#include <format>
 #include <iostream>
+#include <random>
+#include <span>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "ez/bench.h"
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#    define EZ_X86 1
+#    ifdef _MSC_VER
+#        include <intrin.h>
+#    else
+#        include <cpuid.h>
+#    endif
+#endif
+
+// GCC / Clang（包括 clang-cl）可以为单个函数指定指令集，MSVC 只编译基础版本
+#if defined(EZ_X86) && (defined(__GNUC__) || defined(__clang__))
+#    define EZ_MULTIVERSION 1
+#    define EZ_TARGET_AVX2 __attribute__((target("avx2")))
+#    define EZ_FORCE_INLINE [[gnu::always_inline]] inline
+#else
+#    define EZ_TARGET_AVX2
+#    define EZ_FORCE_INLINE inline
+#endif
 
 using std::cout;
+using std::format;
 
 // 没有 concept 时
 template <typename T>
@@ -21,8 +52,295 @@ concept Numeric = std::integral<T> || std::floating_point<T>;
 template <Numeric T>
 auto arg_v1(const T &arg) -> T { return arg + 42; }
 
-auto main() -> int {
+namespace ez {
+#ifdef EZ_MULTIVERSION
+    inline auto xgetbv0() -> uint64_t {
+        uint32_t eax{};
+        uint32_t edx{};
+        asm volatile("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+        return eax | (static_cast<uint64_t>(edx) << 32);
+    }
+#endif
+
+    // 运行期检测 AVX2：CPU 支持，且操作系统保存 YMM 寄存器；没有编译 AVX2 版本时总是 false
+    inline auto has_avx2() -> bool {
+#ifdef EZ_MULTIVERSION
+        static const bool yes{[] {
+            unsigned r[4]{};
+#    ifdef _MSC_VER
+            int info[4]{};
+            __cpuid(info, 1);
+            r[2] = static_cast<unsigned>(info[2]);
+#    else
+            __get_cpuid(1, &r[0], &r[1], &r[2], &r[3]);
+#    endif
+            const bool osxsave{(r[2] & (1U << 27)) != 0};
+            const bool avx{(r[2] & (1U << 28)) != 0};
+            if (!osxsave || !avx || (xgetbv0() & 0x6) != 0x6) { return false; }
+#    ifdef _MSC_VER
+            __cpuidex(info, 7, 0);
+            r[1] = static_cast<unsigned>(info[1]);
+#    else
+            __get_cpuid_count(7, 0, &r[0], &r[1], &r[2], &r[3]);
+#    endif
+            return (r[1] & (1U << 5)) != 0;
+        }()};
+        return yes;
+#else
+        return false;
+#endif
+    }
+
+    // 逐个元素处理的参考实现，用于检查结果
+    namespace ref {
+        template <Numeric T>
+        void add_scalar(std::span<T> v, T k) {
+            for (auto &e : v) { e += k; }
+        }
+        template <Numeric T>
+        void axpy(T a, std::span<const T> x, std::span<T> y) {
+            for (size_t i{}; i < y.size(); ++i) { y[i] += a * x[i]; }
+        }
+        template <Numeric T>
+        auto sum(std::span<const T> v) -> T {
+            T s{};
+            for (const auto e : v) { s += e; }
+            return s;
+        }
+        template <Numeric T>
+        auto minmax(std::span<const T> v) -> std::pair<T, T> {
+            std::pair<T, T> r{v[0], v[0]};
+            for (const auto e : v) {
+                r.first = e < r.first ? e : r.first;
+                r.second = r.second < e ? e : r.second;
+            }
+            return r;
+        }
+        template <Numeric T>
+        void clamp(std::span<T> v, T lo, T hi) {
+            for (auto &e : v) { e = std::clamp(e, lo, hi); }
+        }
+    } // namespace ref
+
+    // 写成编译器能够自动向量化的形式：归约使用 lanes 个独立的累加器，消除循环携带的依赖
+    // 同一份代码分别按基础指令集（x86-64 为 SSE2）和 AVX2 各编译一次
+    namespace impl {
+        template <Numeric T>
+        constexpr size_t lanes{64 / sizeof(T)}; // 两个 AVX2 寄存器
+
+        template <Numeric T>
+        EZ_FORCE_INLINE void add_scalar(T *v, size_t n, T k) {
+            for (size_t i{}; i < n; ++i) { v[i] += k; }
+        }
+
+        template <Numeric T>
+        EZ_FORCE_INLINE void axpy(T a, const T *x, T *y, size_t n) {
+            for (size_t i{}; i < n; ++i) { y[i] += a * x[i]; }
+        }
+
+        template <Numeric T>
+        EZ_FORCE_INLINE auto sum(const T *v, size_t n) -> T {
+            constexpr size_t L{lanes<T>};
+            T acc[L]{};
+            size_t i{};
+            for (; i + L <= n; i += L) {
+                for (size_t j{}; j < L; ++j) { acc[j] += v[i + j]; }
+            }
+            T s{};
+            for (size_t j{}; j < L; ++j) { s += acc[j]; }
+            for (; i < n; ++i) { s += v[i]; }
+            return s;
+        }
+
+        template <Numeric T>
+        EZ_FORCE_INLINE auto minmax(const T *v, size_t n) -> std::pair<T, T> {
+            constexpr size_t L{lanes<T>};
+            T lo[L];
+            T hi[L];
+            std::fill_n(lo, L, v[0]);
+            std::fill_n(hi, L, v[0]);
+            size_t i{};
+            for (; i + L <= n; i += L) {
+                for (size_t j{}; j < L; ++j) {
+                    lo[j] = v[i + j] < lo[j] ? v[i + j] : lo[j];
+                    hi[j] = hi[j] < v[i + j] ? v[i + j] : hi[j];
+                }
+            }
+            std::pair<T, T> r{v[0], v[0]};
+            for (size_t j{}; j < L; ++j) {
+                r.first = lo[j] < r.first ? lo[j] : r.first;
+                r.second = r.second < hi[j] ? hi[j] : r.second;
+            }
+            for (; i < n; ++i) {
+                r.first = v[i] < r.first ? v[i] : r.first;
+                r.second = r.second < v[i] ? v[i] : r.second;
+            }
+            return r;
+        }
+
+        template <Numeric T>
+        EZ_FORCE_INLINE void clamp(T *v, size_t n, T lo, T hi) {
+            for (size_t i{}; i < n; ++i) {
+                const T e{v[i] < lo ? lo : v[i]};
+                v[i] = hi < e ? hi : e;
+            }
+        }
+    } // namespace impl
+
+#define EZ_KERNEL_VERSIONS(ns, attr)                                                                                   \
+    namespace ns {                                                                                                     \
+        template <Numeric T>                                                                                           \
+        attr void add_scalar(std::span<T> v, T k) { impl::add_scalar(v.data(), v.size(), k); }                         \
+        template <Numeric T>                                                                                           \
+        attr void axpy(T a, std::span<const T> x, std::span<T> y) { impl::axpy(a, x.data(), y.data(), y.size()); }     \
+        template <Numeric T>                                                                                           \
+        attr auto sum(std::span<const T> v) -> T { return impl::sum(v.data(), v.size()); }                             \
+        template <Numeric T>                                                                                           \
+        attr auto minmax(std::span<const T> v) -> std::pair<T, T> { return impl::minmax(v.data(), v.size()); }         \
+        template <Numeric T>                                                                                           \
+        attr void clamp(std::span<T> v, T lo, T hi) { impl::clamp(v.data(), v.size(), lo, hi); }                       \
+    }
+
+    EZ_KERNEL_VERSIONS(base, )
+    EZ_KERNEL_VERSIONS(avx2, EZ_TARGET_AVX2)
+#undef EZ_KERNEL_VERSIONS
+
+    // 对外的接口：按 CPU 选择版本；x.size() 必须不小于 y.size()，minmax 要求 v 非空
+    template <Numeric T>
+    void add_scalar(std::span<T> v, std::type_identity_t<T> k) {
+        has_avx2() ? avx2::add_scalar(v, k) : base::add_scalar(v, k);
+    }
+    template <Numeric T>
+    void axpy(std::type_identity_t<T> a, std::span<const T> x, std::span<T> y) {
+        has_avx2() ? avx2::axpy(a, x, y) : base::axpy(a, x, y);
+    }
+    template <Numeric T>
+    auto sum(std::span<const T> v) -> T {
+        return has_avx2() ? avx2::sum(v) : base::sum(v);
+    }
+    template <Numeric T>
+    auto minmax(std::span<const T> v) -> std::pair<T, T> {
+        return has_avx2() ? avx2::minmax(v) : base::minmax(v);
+    }
+    template <Numeric T>
+    void clamp(std::span<T> v, std::type_identity_t<T> lo, std::type_identity_t<T> hi) {
+        has_avx2() ? avx2::clamp(v, lo, hi) : base::clamp(v, lo, hi);
+    }
+} // namespace ez
+
+template <Numeric T>
+auto random_values(size_t n, unsigned seed) -> std::vector<T> {
+    std::mt19937_64 rng{seed};
+    std::vector<T> v(n);
+    for (auto &e : v) {
+        if constexpr (std::floating_point<T>) {
+            e = std::uniform_real_distribution<T>{-1000, 1000}(rng);
+        } else {
+            e = static_cast<T>(std::uniform_int_distribution<int>{-1000, 1000}(rng));
+        }
+    }
+    return v;
+}
+
+// 各种长度（覆盖不满一组 lanes 的尾部）下与参考实现比较
+// 浮点求和的累加顺序不同，按相对误差比较，其余结果必须完全相同
+template <Numeric T>
+auto check(std::string_view type, auto add_scalar, auto axpy, auto sum, auto minmax, auto clamp) -> bool {
+    bool ok{true};
+    for (const size_t n : {1UZ, 3UZ, 15UZ, 16UZ, 17UZ, 63UZ, 64UZ, 65UZ, 1000UZ, 100'003UZ}) {
+        const auto x{random_values<T>(n, 1)};
+        const auto y0{random_values<T>(n, 2)};
+
+        auto a{x};
+        auto b{x};
+        ez::ref::add_scalar<T>(a, 7);
+        add_scalar(std::span<T>{b}, T{7});
+        ok = ok && a == b;
+
+        a = y0;
+        b = y0;
+        ez::ref::axpy<T>(3, x, a);
+        axpy(T{3}, std::span<const T>{x}, std::span<T>{b});
+        ok = ok && a == b;
+
+        const T s0{ez::ref::sum<T>(x)};
+        const T s1{sum(std::span<const T>{x})};
+        if constexpr (std::floating_point<T>) {
+            ok = ok && std::abs(s0 - s1) <= std::abs(s0) * T(1e-3) + T(1e-2);
+        } else {
+            ok = ok && s0 == s1;
+        }
+
+        ok = ok && ez::ref::minmax<T>(x) == minmax(std::span<const T>{x});
+
+        a = x;
+        b = x;
+        ez::ref::clamp<T>(a, -100, 100);
+        clamp(std::span<T>{b}, T{-100}, T{100});
+        ok = ok && a == b;
+    }
+    cout << format("{:<8} {}\n", type, ok ? "ok" : "MISMATCH");
+    return ok;
+}
+
+template <Numeric T>
+auto check_all(std::string_view type) -> bool {
+#define EZ_KERNELS(ns) ez::ns::add_scalar<T>, ez::ns::axpy<T>, ez::ns::sum<T>, ez::ns::minmax<T>, ez::ns::clamp<T>
+    bool ok{check<T>(format("{}/base", type), EZ_KERNELS(base))};
+    if (ez::has_avx2()) { ok = check<T>(format("{}/avx2", type), EZ_KERNELS(avx2)) && ok; }
+#undef EZ_KERNELS
+    return ok;
+}
+
+template <Numeric T>
+void bench_type(ez::bench::Runner &runner, std::string_view type, size_t n) {
+    const auto x{random_values<T>(n, 1)};
+    auto y{random_values<T>(n, 2)};
+    const std::span<const T> cx{x};
+
+    auto run = [&](std::string_view kernel, auto &&ref, auto &&fast) {
+        runner.run(format("1.7/{}/{}/scalar", type, kernel), n, ref);
+        runner.run(format("1.7/{}/{}/{}", type, kernel, ez::has_avx2() ? "avx2" : "base"), n, fast);
+    };
+    run("add_scalar", [&] { ez::ref::add_scalar<T>(y, 1); return y[0]; },
+        [&] { ez::add_scalar<T>(y, 1); return y[0]; });
+    run("axpy", [&] { ez::ref::axpy<T>(2, cx, y); return y[0]; },
+        [&] { ez::axpy<T>(2, cx, y); return y[0]; });
+    run("sum", [&] { return ez::ref::sum(cx); }, [&] { return ez::sum(cx); });
+    run("minmax", [&] { return ez::ref::minmax(cx).first; }, [&] { return ez::minmax(cx).first; });
+    run("clamp", [&] { ez::ref::clamp<T>(y, -100, 100); return y[0]; },
+        [&] { ez::clamp<T>(y, -100, 100); return y[0]; });
+}
+
+// 1 << 20 个元素（int64 / double 为 8 MiB），各内核对比逐个元素的参考实现
+void bench(ez::bench::Runner &runner) {
+    const size_t n{runner.count(0, 1 << 20)};
+    bench_type<int32_t>(runner, "int32", n);
+    bench_type<int64_t>(runner, "int64", n);
+    bench_type<float>(runner, "float", n);
+    bench_type<double>(runner, "double", n);
+}
+
+auto main(int argc, char *argv[]) -> int {
+    if (ez::bench::requested(argc, argv)) {
+        ez::bench::Runner runner{argc, argv};
+        bench(runner);
+        return 0;
+    }
+
     const char *n = "7";
     cout << arg_v0(n) << "\n";
     // cout << arg_v1(n) << "\n"; // 报错：constraints not satisfied
+
+    std::vector<double> v{1.5, -2.0, 40.0};
+    ez::add_scalar<double>(v, 42); // 与 arg_v1 相同的约束，作用于整个 span
+    cout << format("{} {} {}\n", v[0], v[1], v[2]);
+    // ez::add_scalar<const char *>(...); // 报错：constraints not satisfied
+
+    cout << format("avx2: {}\n", ez::has_avx2());
+    bool ok{check_all<int32_t>("int32")};
+    ok = check_all<int64_t>("int64") && ok;
+    ok = check_all<float>("float") && ok;
+    ok = check_all<double>("double") && ok;
+    return ok ? 0 : 1;
 }
@@ -7,14 +7,218 @@
  */
 
 #include <algorithm>
+#include <cstdint>
+#include <execution>
+#include <format>
+#include <functional>
 #include <iostream>
+#include <numeric>
+#include <random>
+#include <optional>
 #include <ranges>
+#include <string_view>
+#include <utility>
 #include <vector>
+
+#include "ez/bench.h"
+#include "ez/sort.h"
+#include "ez/thread_pool.h"
+
 using std::vector;
 
 namespace ranges = std::ranges;
 
-auto main() -> int {
+namespace ez {
+    struct ParOptions {
+        ThreadPool *pool{}; // 默认使用 ez::pool()
+        size_t chunk{};     // 每块的源元素个数，0 表示按 256 KiB 估算
+    };
+
+    template <typename Adaptor>
+    struct par_fn {
+        Adaptor adaptor;
+        ParOptions opt{};
+    };
+
+    // src | par(views::filter(...) | views::transform(...)) | par_reduce(...)
+    // filter 之后的视图不能随机访问，所以切分的是源范围：每块源元素单独套上 adaptor 再串行消费
+    template <typename Adaptor>
+    auto par(Adaptor adaptor, ParOptions opt = {}) -> par_fn<Adaptor> {
+        return {std::move(adaptor), opt};
+    }
+
+    template <ranges::view R, typename Adaptor>
+        requires ranges::random_access_range<const R> && ranges::sized_range<const R>
+    class par_view {
+        R base_;
+        Adaptor adaptor_;
+        ThreadPool *pool_;
+        size_t chunk_;
+
+      public:
+        par_view(R base, Adaptor adaptor, ParOptions opt)
+            : base_{std::move(base)}, adaptor_{std::move(adaptor)}, pool_{opt.pool != nullptr ? opt.pool : &ez::pool()},
+              chunk_{opt.chunk != 0 ? opt.chunk : std::max<size_t>(1024, (256 << 10) / sizeof(ranges::range_value_t<R>))} {}
+
+        [[nodiscard]] auto pool() const -> ThreadPool & { return *pool_; }
+
+        [[nodiscard]] auto chunks() const -> size_t {
+            return (static_cast<size_t>(ranges::size(base_)) + chunk_ - 1) / chunk_;
+        }
+
+        // 第 i 块源元素经过 adaptor 之后的视图
+        [[nodiscard]] auto chunk(size_t i) const {
+            const auto n{static_cast<size_t>(ranges::size(base_))};
+            const auto first{ranges::begin(base_) + static_cast<ptrdiff_t>(i * chunk_)};
+            const auto last{ranges::begin(base_) + static_cast<ptrdiff_t>(std::min(n, (i + 1) * chunk_))};
+            return ranges::subrange(first, last) | adaptor_;
+        }
+    };
+
+    template <ranges::viewable_range R, typename Adaptor>
+    auto operator|(R &&r, par_fn<Adaptor> f) {
+        return par_view<std::views::all_t<R>, Adaptor>{std::views::all(std::forward<R>(r)), std::move(f.adaptor), f.opt};
+    }
+
+    template <typename T, typename Op>
+    struct par_reduce_fn {
+        T init;
+        Op op;
+        bool ordered;
+    };
+
+    // 有序归约：每块的部分结果按块的顺序合并，op 只需满足结合律，结果与串行相同
+    template <typename T, typename Op = std::plus<>>
+    auto par_reduce(T init, Op op = {}) -> par_reduce_fn<T, Op> {
+        return {std::move(init), std::move(op), true};
+    }
+
+    // 无序归约：每个线程先合并自己领取的所有块，op 还需满足交换律
+    template <typename T, typename Op = std::plus<>>
+    auto par_reduce_unordered(T init, Op op = {}) -> par_reduce_fn<T, Op> {
+        return {std::move(init), std::move(op), false};
+    }
+
+    template <typename R, typename A, typename T, typename Op>
+    auto operator|(const par_view<R, A> &v, par_reduce_fn<T, Op> f) -> T {
+        auto &pool{v.pool()};
+        vector<std::optional<T>> partial(f.ordered ? v.chunks() : pool.size());
+        pool.parallel_for(v.chunks(), [&](size_t i, size_t thread) {
+            std::optional<T> acc{};
+            for (auto &&e : v.chunk(i)) {
+                acc = acc ? f.op(std::move(*acc), std::forward<decltype(e)>(e)) : T(std::forward<decltype(e)>(e));
+            }
+            if (!acc) { return; }
+            auto &slot{partial[f.ordered ? i : thread]};
+            slot = slot ? f.op(std::move(*slot), std::move(*acc)) : std::move(acc);
+        });
+        T result{std::move(f.init)};
+        for (auto &p : partial) {
+            if (p) { result = f.op(std::move(result), std::move(*p)); }
+        }
+        return result;
+    }
+
+    struct to_vector_par_fn {
+        bool ordered;
+    };
+
+    // 收集为 vector：有序版本与串行遍历的顺序相同，无序版本按线程拼接
+    inline constexpr to_vector_par_fn to_vector_par{true};
+    inline constexpr to_vector_par_fn to_vector_par_unordered{false};
+
+    template <typename R, typename A>
+    auto operator|(const par_view<R, A> &v, to_vector_par_fn f) {
+        using V = ranges::range_value_t<decltype(v.chunk(0))>;
+        auto &pool{v.pool()};
+        vector<vector<V>> parts(f.ordered ? v.chunks() : pool.size());
+        pool.parallel_for(v.chunks(), [&](size_t i, size_t thread) {
+            auto &out{parts[f.ordered ? i : thread]};
+            for (auto &&e : v.chunk(i)) { out.push_back(std::forward<decltype(e)>(e)); }
+        });
+
+        vector<size_t> offset(parts.size() + 1);
+        for (size_t i{}; i < parts.size(); ++i) { offset[i + 1] = offset[i] + parts[i].size(); }
+        vector<V> result(offset.back());
+        pool.parallel_for(parts.size(), [&](size_t i, size_t) {
+            std::ranges::move(parts[i], result.begin() + static_cast<ptrdiff_t>(offset[i]));
+            vector<V>{}.swap(parts[i]);
+        });
+        return result;
+    }
+} // namespace ez
+
+// 10^8 个 iota 元素经过 filter | transform 后求和：串行视图、不同线程数的 par_reduce，
+// 以及对同样数据的 vector 使用 std::transform_reduce(std::execution::par)
+void bench(ez::bench::Runner &runner) {
+    const size_t n{runner.count(0, 100'000'000)};
+    const auto src{std::views::iota(int64_t{}, static_cast<int64_t>(n))};
+    const auto keep = [](int64_t x) { return x % 3 != 0; };
+    const auto f = [](int64_t x) { return (x * x) & 0xffff; };
+    const auto pipeline{std::views::filter(keep) | std::views::transform(f)};
+
+    runner.run("1.9/serial view", n, [&] {
+        int64_t sum{};
+        for (const int64_t v : src | pipeline) { sum += v; }
+        return sum;
+    });
+    vector<size_t> threads{};
+    for (size_t t{1}; t < ez::pool().size(); t *= 2) { threads.push_back(t); }
+    threads.push_back(ez::pool().size());
+    for (const size_t t : threads) {
+        ez::ThreadPool pool{t};
+        runner.run(std::format("1.9/par_reduce/{}", t), n,
+                   [&] { return src | ez::par(pipeline, {.pool = &pool}) | ez::par_reduce(int64_t{}); });
+    }
+    runner.run("1.9/par_reduce_unordered", n, [&] { return src | ez::par(pipeline) | ez::par_reduce_unordered(int64_t{}); });
+    runner.run("1.9/to_vector_par", n / 10, [&] {
+        return (src | std::views::take(n / 10) | ez::par(pipeline) | ez::to_vector_par).size();
+    });
+    runner.run("1.9/to_vector_par_unordered", n / 10, [&] {
+        return (src | std::views::take(n / 10) | ez::par(pipeline) | ez::to_vector_par_unordered).size();
+    });
+
+    vector<int64_t> data(n);
+    std::iota(data.begin(), data.end(), int64_t{});
+    runner.run("1.9/vector par_reduce", n, [&] { return data | ez::par(pipeline) | ez::par_reduce(int64_t{}); });
+    runner.run("1.9/transform_reduce(par)", n, [&] {
+        return std::transform_reduce(std::execution::par, data.begin(), data.end(), int64_t{}, std::plus<>{},
+                                     [&](int64_t x) { return keep(x) ? f(x) : 0; });
+    });
+}
+
+// 10^7 个随机 int：ranges::sort、std::sort(par)、并行归并排序和基数排序
+void bench_sort(ez::bench::Runner &runner) {
+    const size_t n{runner.count(1, 10'000'000)};
+    std::mt19937 rng{42};
+    vector<int> data(n);
+    for (auto &e : data) { e = static_cast<int>(rng()); }
+    vector<int> expected{data};
+    ranges::sort(expected);
+
+    auto run = [&](std::string_view name, auto &&sort) {
+        vector<int> v{};
+        runner.run(std::format("1.9/sort/{}", name), n, [&] { return data; }, [&](vector<int> &s) {
+            sort(s);
+            v = std::move(s);
+            return v.size();
+        });
+        std::cerr << std::format("{:<16} {}\n", name, v == expected ? "sorted" : "WRONG");
+    };
+    run("ranges::sort", [](vector<int> &v) { ranges::sort(v); });
+    run("std::sort(par)", [](vector<int> &v) { std::sort(std::execution::par, v.begin(), v.end()); });
+    run("ez::par_sort", [](vector<int> &v) { ez::par_sort(v); });
+    run("ez::radix_sort", [](vector<int> &v) { ez::radix_sort(v); });
+}
+
+auto main(int argc, char *argv[]) -> int {
+    if (ez::bench::requested(argc, argv)) {
+        ez::bench::Runner runner{argc, argv, {.warmup = 1, .runs = 5}};
+        bench(runner);
+        bench_sort(runner);
+        return 0;
+    }
+
     const vector<int> nums{1, 2, 3, 4, 5, 6, 7, 8, 9, 10};
     auto result_1 = ranges::take_view(nums, 5); // 返回前 n 个元素的视图
     for (auto v : result_1) { std::cout << v << " "; }
@@ -54,4 +258,21 @@ auto main() -> int {
         std::cout << i << " ";
     }
     std::cout << "\n";
+
+    // 与 ranges::sort 相同的比较器和投影参数
+    ez::par_sort(v, ranges::greater{});
+    for (int i : v) { std::cout << i << " "; }
+    std::cout << "\n";
+    vector<std::pair<std::string_view, int>> ranked{{"c", 3}, {"a", -1}, {"b", 2}};
+    ez::radix_sort(ranked, &std::pair<std::string_view, int>::second);
+    for (const auto &[name, rank] : ranked) { std::cout << name << ":" << rank << " "; }
+    std::cout << "\n";
+
+    // 切分源范围，每块在线程池中经过 filter | transform，再按块的顺序归并
+    const auto even_squares{std::views::filter([](int i) { return 0 == i % 2; }) | std::views::transform([](int i) { return i * i; })};
+    const ez::ParOptions small{.chunk = 3};
+    std::cout << (nums | ez::par(even_squares, small) | ez::par_reduce(0)) << "\n"; // 220
+    for (auto v : nums | ez::par(even_squares, small) | ez::to_vector_par) { std::cout << v << " "; }
+    std::cout << "\n";
+    std::cout << (std::views::iota(1, 101) | ez::par(std::views::transform([](int i) { return i; })) | ez::par_reduce(0)) << "\n";
 }
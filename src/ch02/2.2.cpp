@@ -6,9 +6,22 @@
  * @Description  : span 类
  */
 
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
 #include <format>
 #include <iostream>
+#include <memory>
+#include <numeric>
+#include <ranges>
 #include <span>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "ez/bench.h"
 
 using std::cout;
 using std::format;
@@ -24,7 +37,238 @@ void pspan(span<T> s) {
     cout << "\n";
 }
 
-auto main() -> int {
+// 以 span 为中心的批处理工具，全部只产生子 span，不复制元素
+// 块长作为模板参数时得到 span<T, N>，循环次数在编译期已知，编译器可以完全展开块内的循环
+namespace ez {
+    // 提示 CPU 把 p 所在的缓存行读入缓存
+    inline void prefetch(const void *p) {
+#if defined(__GNUC__) || defined(__clang__)
+        __builtin_prefetch(p);
+#else
+        (void)p;
+#endif
+    }
+
+    // 不重叠的完整块，每块 span<T, N>；余下的 s.size() % N 个元素用 chunk_tail<N>(s) 取得
+    template <size_t N, typename T, size_t E>
+        requires(N > 0)
+    constexpr auto chunk(span<T, E> s) {
+        return std::views::iota(size_t{}, s.size() / N) |
+               std::views::transform([s](size_t i) { return span<T, N>{s.data() + i * N, N}; });
+    }
+
+    // 余下不足一块的部分；s 为静态长度时结果也是静态长度
+    template <size_t N, typename T, size_t E>
+        requires(N > 0)
+    constexpr auto chunk_tail(span<T, E> s) {
+        if constexpr (E == std::dynamic_extent) {
+            return s.last(s.size() % N);
+        } else {
+            return s.template last<E % N>();
+        }
+    }
+
+    // 块长在运行期确定，最后一块可能较短，与 std::views::chunk 相同；n 为 0 时按 1 处理
+    template <typename T, size_t E>
+    constexpr auto chunk(span<T, E> s, size_t n) {
+        n = std::max<size_t>(n, 1);
+        return std::views::iota(size_t{}, (s.size() + n - 1) / n) |
+               std::views::transform([s, n](size_t i) { return span<T>{s}.subspan(i * n, std::min(n, s.size() - i * n)); });
+    }
+
+    // 长度为 N 的滑动窗口，相邻窗口相差一个元素，共 s.size() - N + 1 个
+    template <size_t N, typename T, size_t E>
+        requires(N > 0)
+    constexpr auto slide(span<T, E> s) {
+        return std::views::iota(size_t{}, s.size() >= N ? s.size() - N + 1 : 0) |
+               std::views::transform([s](size_t i) { return span<T, N>{s.data() + i, N}; });
+    }
+
+    // 窗口长度在运行期确定；n 为 0 时按 1 处理，与 chunk 相同
+    template <typename T, size_t E>
+    constexpr auto slide(span<T, E> s, size_t n) {
+        n = std::max<size_t>(n, 1);
+        return std::views::iota(size_t{}, s.size() >= n ? s.size() - n + 1 : 0) |
+               std::views::transform([s, n](size_t i) { return span<T>{s.data() + i, n}; });
+    }
+
+    // 按 Align 字节对齐切分：head 为对齐前的元素，body 起始地址按 Align 对齐且长度为 Align 字节的整数倍，tail 为剩余部分
+    // body 可以配合 std::assume_aligned 使用对齐的 SIMD 读写
+    template <typename T>
+    struct Aligned {
+        span<T> head{};
+        span<T> body{};
+        span<T> tail{};
+    };
+
+    template <size_t Align, typename T, size_t E>
+        requires(std::has_single_bit(Align) && Align % sizeof(T) == 0 && sizeof(T) == alignof(T))
+    auto split_aligned(span<T, E> s) -> Aligned<T> {
+        constexpr size_t lanes{Align / sizeof(T)};
+        const auto addr{reinterpret_cast<std::uintptr_t>(s.data())};
+        const size_t skip{std::min(s.size(), ((Align - addr % Align) % Align) / sizeof(T))};
+        const size_t body{(s.size() - skip) / lanes * lanes};
+        return {s.first(skip), span<T>{s}.subspan(skip, body), span<T>{s}.subspan(skip + body)};
+    }
+
+    namespace detail {
+        constexpr size_t cache_line{64};
+        constexpr size_t prefetch_limit{4096}; // 硬件预取不跨页，每次最多提示一页
+
+        template <typename T>
+        void prefetch_range(const T *p, size_t n) {
+            const auto *b{reinterpret_cast<const std::byte *>(p)};
+            const size_t bytes{std::min(n * sizeof(T), prefetch_limit)};
+            for (size_t off{}; off < bytes; off += cache_line) { prefetch(b + off); }
+        }
+    } // namespace detail
+
+    // 依次对每个长度为 N 的块调用 fn(span<T, N>)，处理当前块前先预取下一块；最后不足一块的部分以 span<T> 调用一次
+    template <size_t N, typename T, size_t E, typename F>
+        requires(N > 0)
+    void process_in_batches(span<T, E> s, F &&fn) {
+        const size_t full{s.size() / N};
+        for (size_t i{}; i < full; ++i) {
+            if (i + 1 < full) { detail::prefetch_range(s.data() + (i + 1) * N, N); }
+            fn(span<T, N>{s.data() + i * N, N});
+        }
+        if (const auto rest{span<T>{s}.subspan(full * N)}; !rest.empty()) { fn(rest); }
+    }
+
+    // 批大小在运行期确定，每批都是 span<T>；batch 为 0 时按 1 处理
+    template <typename T, size_t E, typename F>
+    void process_in_batches(span<T, E> s, size_t batch, F &&fn) {
+        batch = std::max<size_t>(batch, 1);
+        for (size_t i{}; i < s.size(); i += batch) {
+            const size_t n{std::min(batch, s.size() - i)};
+            if (i + n < s.size()) { detail::prefetch_range(s.data() + i + n, std::min(batch, s.size() - i - n)); }
+            fn(span<T>{s}.subspan(i, n));
+        }
+    }
+} // namespace ez
+
+constexpr auto chunk_sums() {
+    std::array<int, 10> a{};
+    std::iota(a.begin(), a.end(), 1);
+    const span s{a};
+    std::array<int, 3> sums{};
+    for (size_t i{}; const auto c : ez::chunk<3>(s)) {
+        static_assert(decltype(c)::extent == 3);
+        sums[i++] = c[0] + c[1] + c[2];
+    }
+    return sums;
+}
+
+static_assert(chunk_sums() == std::array{6, 15, 24});
+static_assert(std::ranges::size(ez::chunk(span<const int>{std::array{1, 2, 3}}, 0)) == 3);
+static_assert(std::ranges::size(ez::slide(span<const int>{std::array{1, 2, 3}}, 0)) == 3);
+static_assert(decltype(ez::chunk_tail<3>(std::declval<span<int, 10>>()))::extent == 1);
+static_assert(decltype(ez::chunk_tail<5>(std::declval<span<int, 10>>()))::extent == 0);
+
+// 每个元素乘 0.5 后累加，对比按下标的循环；分块累加改变了浮点加法的顺序，结果可能有舍入差异
+void bench(ez::bench::Runner &runner) {
+    const size_t n{runner.count(0, size_t{1} << 24)};
+    std::vector<float> v(n);
+    std::iota(v.begin(), v.end(), 0.0F);
+    for (auto &e : v) { e = e * 1e-6F; }
+    const span<const float> s{v};
+    constexpr size_t batch{256};
+
+    runner.run("2.2/scale_sum/index", n, [&] {
+        float sum{};
+        for (size_t i{}; i < v.size(); ++i) { sum += v[i] * 0.5F; }
+        return sum;
+    });
+    runner.run("2.2/scale_sum/chunk<16>", n, [&] {
+        std::array<float, 16> acc{};
+        for (const auto c : ez::chunk<16>(s)) {
+            for (size_t j{}; j < c.size(); ++j) { acc[j] += c[j] * 0.5F; }
+        }
+        float sum{std::accumulate(acc.begin(), acc.end(), 0.0F)};
+        for (const float e : ez::chunk_tail<16>(s)) { sum += e * 0.5F; }
+        return sum;
+    });
+    runner.run("2.2/scale_sum/process_in_batches<256>", n, [&] {
+        float sum{};
+        ez::process_in_batches<batch>(s, [&](auto b) {
+            std::array<float, 16> acc{};
+            const size_t full{b.size() / 16 * 16};
+            for (size_t j{}; j < full; j += 16) {
+                for (size_t k{}; k < 16; ++k) { acc[k] += b[j + k] * 0.5F; }
+            }
+            for (size_t j{full}; j < b.size(); ++j) { sum += b[j] * 0.5F; }
+            sum += std::accumulate(acc.begin(), acc.end(), 0.0F);
+        });
+        return sum;
+    });
+    runner.run("2.2/scale_sum/split_aligned<32>", n, [&] {
+        const auto [head, body, tail]{ez::split_aligned<32>(s)};
+        float sum{};
+        for (const float e : head) { sum += e * 0.5F; }
+        const float *p{std::assume_aligned<32>(body.data())};
+        std::array<float, 8> acc{};
+        for (size_t j{}; j < body.size(); j += 8) {
+            for (size_t k{}; k < 8; ++k) { acc[k] += p[j + k] * 0.5F; }
+        }
+        for (const float e : tail) { sum += e * 0.5F; }
+        return sum + std::accumulate(acc.begin(), acc.end(), 0.0F);
+    });
+
+    // 长度 8 的滑动平均
+    std::vector<float> out(n);
+    runner.run("2.2/moving_avg8/index", n, [&] {
+        for (size_t i{}; i + 8 <= v.size(); ++i) {
+            float t{};
+            for (size_t k{}; k < 8; ++k) { t += v[i + k]; }
+            out[i] = t * 0.125F;
+        }
+        return out[0];
+    });
+    runner.run("2.2/moving_avg8/slide<8>", n, [&] {
+        for (size_t i{}; const auto w : ez::slide<8>(s)) {
+            float t{};
+            for (const float e : w) { t += e; }
+            out[i++] = t * 0.125F;
+        }
+        return out[0];
+    });
+}
+
+auto main(int argc, char *argv[]) -> int {
+    if (ez::bench::requested(argc, argv)) {
+        ez::bench::Runner runner{argc, argv};
+        bench(runner);
+        return 0;
+    }
+
     int carray[]{1, 2, 3, 4, 5, 6, 7, 8, 9, 10};
     pspan<int>(carray);
+
+    auto show = [](std::string_view name, auto sub) {
+        cout << format("{}:", name);
+        for (const int e : sub) { cout << format(" {}", e); }
+        cout << "\n";
+    };
+    const span s{carray}; // span<int, 10>
+    for (const auto c : ez::chunk<4>(s)) { show("chunk<4>", c); }
+    show("chunk_tail<4>", ez::chunk_tail<4>(s));
+    for (const auto c : ez::chunk(span<int>{s}, 3)) { show("chunk(3)", c); }
+    for (const auto w : ez::slide<8>(s)) { show("slide<8>", w); }
+
+    std::vector<int> big(1000);
+    std::iota(big.begin(), big.end(), 0);
+    const auto [head, body, tail]{ez::split_aligned<32>(span{big})};
+    cout << format("aligned: head {} body {} tail {}\n", head.size(), body.size(), tail.size());
+
+    long sum{};
+    size_t batches{};
+    ez::process_in_batches<128>(span{big}, [&](auto b) {
+        ++batches;
+        for (const int e : b) { sum += e; }
+    });
+    cout << format("{} batches, sum {}\n", batches, sum); // 8 batches, sum 499500
+
+    batches = 0;
+    ez::process_in_batches(span{big}.first(5), 0, [&](auto) { ++batches; });
+    cout << format("batch 0: {} batches\n", batches); // batch 0: 5 batches
 }
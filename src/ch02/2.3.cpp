@@ -6,13 +6,24 @@
  * @Description  : 结构化绑定
  */
 
+#include <algorithm>
 #include <array>
 #include <cstdint>
 #include <format>
+#include <functional>
 #include <iostream>
+#include <iterator>
+#include <limits>
 #include <map>
+#include <optional>
+#include <random>
 #include <string>
+#include <string_view>
 #include <tuple>
+#include <vector>
+
+#include "ez/bench.h"
+#include "ez/grouped.h"
 
 using std::array;
 using std::cin;
@@ -35,22 +46,82 @@ auto int_div(const long &num, const long &denom) -> div_result {
     return r;
 }
 
-const std::map<string, uint64_t> inhabitants{
+// std::less<> 为透明比较器，可以直接用 string_view 或 const char* 查找
+const std::map<string, uint64_t, std::less<>> inhabitants{
     {"humans", 7000000000},
     {"pokemon", 17863376},
     {"klingons", 24246291},
     {"cats", 1086881528}};
 
+auto population(std::string_view creature) -> std::optional<uint64_t> {
+    if (const auto it{inhabitants.find(creature)}; it != inhabitants.end()) { return it->second; }
+    return std::nullopt;
+}
+
+constexpr auto grouped_equals(uint64_t num, std::string_view expect, char sep = ',') -> bool {
+    char buf[ez::max_grouped]{};
+    char *end{buf + ez::max_grouped};
+    const char *b{ez::group_digits(end, num, sep)};
+    return std::string_view(b, static_cast<size_t>(end - b)) == expect;
+}
+
+static_assert(grouped_equals(0, "0"));
+static_assert(grouped_equals(7, "7"));
+static_assert(grouped_equals(999, "999"));
+static_assert(grouped_equals(1000, "1,000"));
+static_assert(grouped_equals(100000, "100,000"));
+static_assert(grouped_equals(1234567, "1,234,567"));
+static_assert(grouped_equals(7000000000, "7.000.000.000", '.'));
+static_assert(grouped_equals(std::numeric_limits<uint64_t>::max(), "18,446,744,073,709,551,615"));
+
 // 使用结构化绑定来检索键值对
-auto make_commas(const uint64_t num) -> string {
+auto make_commas(const uint64_t num) -> string { return ez::to_grouped(num); }
+
+// 原来的实现，反复 insert 为 O(n^2)；原循环在不足 3 位时下标回绕，这里加了判断，仅用于对比
+auto make_commas_insert(const uint64_t num) -> string {
     string s{std::to_string(num)};
-    for (unsigned long long l = s.length() - 3; l > 0; l -= 3) {
+    for (size_t l{s.length() > 3 ? s.length() - 3 : 0}; l > 0; l = l > 3 ? l - 3 : 0) {
         s.insert(l, ",");
     }
     return s;
 }
 
-auto main() -> int {
+// 随机位数的数字逐个分组，对比 insert、一次写入、format 和直接写入缓冲
+void bench(ez::bench::Runner &runner) {
+    const size_t n{runner.count(0, 1'000'000)};
+    std::mt19937_64 rng{42};
+    std::vector<uint64_t> nums(n);
+    for (auto &v : nums) { v = rng() >> (rng() % 64); }
+
+    auto run = [&](std::string_view name, auto &&f) {
+        runner.run(format("2.3/{}", name), n, [&] {
+            size_t chars{};
+            for (const auto v : nums) { chars += f(v); }
+            return chars;
+        });
+    };
+
+    string buf{};
+    run("make_commas_insert", [](uint64_t v) { return make_commas_insert(v).size(); });
+    run("make_commas", [](uint64_t v) { return make_commas(v).size(); });
+    run("format {}", [&](uint64_t v) {
+        buf.clear();
+        std::format_to(std::back_inserter(buf), "{}", ez::grouped{v});
+        return buf.size();
+    });
+    run("format_grouped_to", [](uint64_t v) {
+        char out[ez::max_grouped];
+        return static_cast<size_t>(ez::format_grouped_to(out, v) - out);
+    });
+}
+
+auto main(int argc, char *argv[]) -> int {
+    if (ez::bench::requested(argc, argv)) {
+        ez::bench::Runner runner{argc, argv};
+        bench(runner);
+        return 0;
+    }
+
     { // 和 C 数组 一起使用
         int nums[]{1, 2, 3, 4, 5};
         auto [a, b, c, d, e] = nums;
@@ -100,5 +171,12 @@ auto main() -> int {
         for (const auto &[creature, pop] : inhabitants) {
             cout << format("there are {} {}\n", make_commas(pop), creature);
         }
+        for (const auto &[creature, pop] : inhabitants) {
+            cout << format("there are {:_} {}\n", ez::grouped{pop}, creature);
+        }
+        for (const char *creature : {"cats", "dogs"}) {
+            const auto pop{population(creature)};
+            cout << format("{}: {}\n", creature, pop ? make_commas(*pop) : "unknown");
+        }
     }
 }
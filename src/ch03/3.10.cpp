@@ -1,25 +1,235 @@
 #include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
 #include <format>
 #include <iostream>
 #include <iterator>
+#include <memory>
+#include <optional>
+#include <random>
 #include <set>
+#include <sstream>
 #include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "ez/args.h"
+#include "ez/bench.h"
+#include "ez/trace.h"
+
+#ifdef _WIN32
+#    define WIN32_LEAN_AND_MEAN
+#    include <windows.h>
+#    include <psapi.h>
+#else
+#    include <sys/resource.h>
+#endif
 
 using std::cin, std::cout, std::endl;
 using std::format;
 using std::string;
+using std::string_view;
 
 using input_it = std::istream_iterator<string>;
 
-auto main() -> int {
-    std::set<std::string> words;
-    input_it it{cin};
-    input_it end{};
-    std::copy(it, end, std::inserter(words, words.end()));
-    for (const string &w : words) {
-        cout << format("{} ", w);
+namespace ez {
+    // 进程的峰值常驻内存，单位 MiB
+    auto peak_rss_mib() -> double {
+#ifdef _WIN32
+        PROCESS_MEMORY_COUNTERS pmc{};
+        K32GetProcessMemoryInfo(GetCurrentProcess(), &pmc, sizeof(pmc));
+        return static_cast<double>(pmc.PeakWorkingSetSize) / (1 << 20);
+#else
+        rusage ru{};
+        getrusage(RUSAGE_SELF, &ru);
+#    ifdef __APPLE__
+        return static_cast<double>(ru.ru_maxrss) / (1 << 20); // 字节
+#    else
+        return static_cast<double>(ru.ru_maxrss) / (1 << 10); // KiB
+#    endif
+#endif
+    }
+
+    auto read_all(std::FILE *in) -> string {
+        constexpr size_t chunk{1 << 20};
+        string data{};
+        auto buf{std::make_unique_for_overwrite<char[]>(chunk)};
+        for (size_t n{}; (n = std::fread(buf.get(), 1, chunk, in)) != 0;) {
+            data.append(buf.get(), n);
+        }
+        return data;
+    }
+
+    // 与 istream_iterator<string> 相同，以空白字符分隔
+    constexpr auto is_space(char c) -> bool {
+        return c == ' ' || c == '\t' || c == '\n' || c == '\v' || c == '\f' || c == '\r';
+    }
+
+    // 以 string_view 为元素的开放寻址（线性探测）哈希集合，空 view 表示空槽
+    class ViewSet {
+        std::vector<string_view> slots_{std::vector<string_view>(1 << 16)};
+        size_t size_{};
+
+        static auto hash(string_view w) -> size_t { // FNV-1a
+            uint64_t h{14695981039346656037ULL};
+            for (const unsigned char c : w) {
+                h = (h ^ c) * 1099511628211ULL;
+            }
+            return static_cast<size_t>(h);
+        }
+
+        auto slot_of(string_view w) -> string_view & {
+            const size_t mask{slots_.size() - 1};
+            size_t i{hash(w) & mask};
+            while (!slots_[i].empty() && slots_[i] != w) { i = (i + 1) & mask; }
+            return slots_[i];
+        }
+
+      public:
+        void insert(string_view w) {
+            if ((size_ + 1) * 2 > slots_.size()) {
+                EZ_TRACE_COUNT("3.10/rehash", 1);
+                auto old{std::exchange(slots_, std::vector<string_view>(slots_.size() * 2))};
+                for (const auto v : old) {
+                    if (!v.empty()) { slot_of(v) = v; }
+                }
+            }
+            if (auto &s{slot_of(w)}; s.empty()) {
+                s = w;
+                ++size_;
+            }
+        }
+
+        // 取出所有元素并排序，顺序与 std::set<string> 相同
+        [[nodiscard]] auto sorted() const -> std::vector<string_view> {
+            EZ_TRACE_SCOPE("3.10/sort");
+            std::vector<string_view> words{};
+            words.reserve(size_);
+            std::ranges::copy_if(slots_, std::back_inserter(words), [](string_view v) { return !v.empty(); });
+            std::ranges::sort(words);
+            return words;
+        }
+    };
+
+    // 单词以 string_view 的形式指向 buf，不复制也不逐个分配
+    auto unique_words(string_view buf) -> std::vector<string_view> {
+        ViewSet set{};
+        {
+            EZ_TRACE_SCOPE("3.10/arena insert");
+            size_t tokens{};
+            for (size_t i{}; i < buf.size();) {
+                while (i < buf.size() && is_space(buf[i])) { ++i; }
+                const size_t b{i};
+                while (i < buf.size() && !is_space(buf[i])) { ++i; }
+                if (i > b) {
+                    set.insert(buf.substr(b, i - b));
+                    ++tokens;
+                }
+            }
+            EZ_TRACE_COUNT("3.10/tokens", tokens);
+        }
+        return set.sorted();
+    }
+
+    // 生成约 mib MiB 的随机单词语料，单词取自有限的词表以产生重复，每行交给 sink
+    void generate(size_t mib, auto &&sink) {
+        std::mt19937 rng{42};
+        std::vector<string> vocab(200'000);
+        for (auto &w : vocab) {
+            w.resize(3 + rng() % 10);
+            for (auto &c : w) { c = static_cast<char>('a' + rng() % 26); }
+        }
+        string line{};
+        for (size_t written{}; written < mib << 20; written += line.size()) {
+            line.clear();
+            for (int i{}; i < 12; ++i) {
+                line += vocab[rng() % vocab.size()];
+                line += i == 11 ? '\n' : ' ';
+            }
+            sink(line);
+        }
+    }
+} // namespace ez
+
+constexpr size_t max_mib{4096}; // --gen 和 --bench 语料大小的上限
+
+// 在内存中生成语料，对比 std::set<string> 与 string_view 哈希去重，峰值内存需用 --stats 分别运行
+void bench(ez::bench::Runner &runner) {
+    string corpus{};
+    ez::generate(std::clamp<size_t>(runner.count(0, 64), 1, max_mib), [&corpus](string_view line) { corpus += line; });
+
+    runner.run("3.10/set", corpus.size(), [&] {
+        std::istringstream iss{corpus};
+        std::set<std::string> words;
+        std::copy(input_it{iss}, input_it{}, std::inserter(words, words.end()));
+        return words.size();
+    });
+    runner.run("3.10/arena", corpus.size(), [&] { return ez::unique_words(corpus).size(); });
+}
+
+// 用法：0310 [--arena] [--stats] < file
+//       0310 --gen MiB > file
+//       0310 --bench [MiB]
+// --stats 将耗时和峰值内存输出到 stderr，两种方式需分别运行以比较峰值内存
+auto main(int argc, char *argv[]) -> int {
+    if (ez::bench::requested(argc, argv)) {
+        ez::bench::Runner runner{argc, argv, {.warmup = 1, .runs = 5}};
+        bench(runner);
+        return 0;
+    }
+
+    bool arena{};
+    bool stats{};
+    for (int i{1}; i < argc; ++i) {
+        const string_view arg{argv[i]};
+        if (arg == "--gen") {
+            const auto mib{i + 1 < argc ? ez::parse_size(argv[i + 1], 1, max_mib) : std::nullopt};
+            if (!mib) {
+                std::cerr << format("--gen: expected 1..{} MiB, got \"{}\"\n", max_mib, i + 1 < argc ? argv[i + 1] : "");
+                return 1;
+            }
+            ez::generate(*mib, [](string_view line) { std::fwrite(line.data(), 1, line.size(), stdout); });
+            return 0;
+        }
+        arena = arena || arg == "--arena";
+        stats = stats || arg == "--stats";
+    }
+
+    const auto t0{std::chrono::steady_clock::now()};
+    if (arena) {
+        string buf{};
+        {
+            EZ_TRACE_SCOPE("3.10/read");
+            buf = ez::read_all(stdin);
+        }
+        for (const string_view w : ez::unique_words(buf)) {
+            cout << format("{} ", w);
+        }
+        cout << endl;
+    } else {
+        std::set<std::string> words;
+        {
+            EZ_TRACE_SCOPE("3.10/set insert");
+            input_it it{cin};
+            input_it end{};
+            std::copy(it, end, std::inserter(words, words.end()));
+        }
+        EZ_TRACE_COUNT("3.10/set size", words.size());
+        for (const string &w : words) {
+            cout << format("{} ", w);
+        }
+        cout << endl;
+    }
+    const auto t1{std::chrono::steady_clock::now()};
+
+    if (stats) {
+        std::cerr << format("{}: {:.3f} s, peak RSS {:.1f} MiB\n", arena ? "arena" : "set",
+                            std::chrono::duration<double>(t1 - t0).count(), ez::peak_rss_mib());
     }
-    cout << endl;
 }
 
 // "a a a b c this that this foo foo foo" | .\build\windows\x64\release\ch03_3.10.exe
+// .\build\windows\x64\release\ch03_3.10.exe --gen 1024 > corpus.txt
+// cmd /c ".\build\windows\x64\release\ch03_3.10.exe --arena --stats < corpus.txt > nul"
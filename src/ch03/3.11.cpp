@@ -1,18 +1,308 @@
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
 #include <deque>
 #include <format>
 #include <iostream>
 #include <limits>
 #include <map>
+#include <mutex>
+#include <optional>
+#include <random>
+#include <span>
+#include <sstream>
+#include <stdexcept>
 #include <string>
+#include <string_view>
+#include <system_error>
+#include <thread>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#    include <csignal>
+#    include <sys/socket.h>
+#    include <sys/stat.h>
+#    include <sys/un.h>
+#    include <unistd.h>
+#    define EZ_UNIX_SOCKET 1
+#endif
+
+#include "ez/args.h"
+#include "ez/bench.h"
+#include "ez/small_vector.h"
+#include "ez/string_map.h"
+#include "ez/trace.h"
 
 using std::cin, std::cout, std::endl;
 using std::format;
 using std::string;
+using std::string_view;
+
+namespace ez {
+    constexpr double zero_{0.0};
+    constexpr double inf_{std::numeric_limits<double>::infinity()};
+
+    enum class Opcode : std::uint8_t { push, load, add, sub, mul, div, pow, mod };
+
+    // 每个运算符只有一个字符，用 switch 代替每次重建的 map
+    constexpr auto to_opcode(string_view s) -> std::optional<Opcode> {
+        if (s.size() != 1) { return std::nullopt; }
+        switch (s[0]) {
+        case '+': return Opcode::add;
+        case '-': return Opcode::sub;
+        case '*': return Opcode::mul;
+        case '/': return Opcode::div;
+        case '^': return Opcode::pow;
+        case '%': return Opcode::mod;
+        default: return std::nullopt;
+        }
+    }
+
+    constexpr auto is_numeric(string_view s) -> bool {
+        for (const char c : s) {
+            if (c != '.' && (c < '0' || c > '9')) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // 变量名只能是标识符 [A-Za-z_][A-Za-z0-9_]*，不会与数字或运算符记号混淆
+    constexpr auto is_identifier(string_view s) -> bool {
+        auto alpha = [](char c) { return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_'; };
+        if (s.empty() || !alpha(s[0])) { return false; }
+        return std::ranges::all_of(s, [&](char c) { return alpha(c) || (c >= '0' && c <= '9'); });
+    }
+
+    // name=value 形式的赋值记号，拆成名字和值；"+=3" 之类不是赋值
+    constexpr auto split_assignment(string_view s) -> std::optional<std::pair<string_view, string_view>> {
+        const auto eq{s.find('=')};
+        if (eq == string_view::npos) { return std::nullopt; }
+        const auto name{s.substr(0, eq)};
+        const auto value{s.substr(eq + 1)};
+        if (!is_identifier(name) || value.empty() || !is_numeric(value)) { return std::nullopt; }
+        return std::pair{name, value};
+    }
+
+    // 与 stod 一样在第二个小数点处停止；常量求值时使用手写解析
+    constexpr auto parse_number(string_view s) -> double {
+        if (!std::is_constant_evaluated()) {
+            double v{zero_};
+            std::from_chars(s.data(), s.data() + s.size(), v);
+            return v;
+        }
+        double v{zero_};
+        double scale{0.0};
+        for (const char c : s) {
+            if (c == '.') {
+                if (scale != 0.0) { break; }
+                scale = 1.0;
+                continue;
+            }
+            if (scale == 0.0) {
+                v = v * 10 + (c - '0');
+            } else {
+                scale /= 10;
+                v += (c - '0') * scale;
+            }
+        }
+        return v;
+    }
+
+    // 常量求值时 std::pow 和 std::fmod 不可用，^ 只支持整数指数
+    constexpr auto apply(Opcode op, double l, double r) -> double {
+        switch (op) {
+        case Opcode::add: return l + r;
+        case Opcode::sub: return l - r;
+        case Opcode::mul: return l * r;
+        case Opcode::div: return r == zero_ ? inf_ : l / r;
+        case Opcode::pow:
+            if (std::is_constant_evaluated()) {
+                const auto n{static_cast<long long>(r)};
+                if (static_cast<double>(n) != r) { throw std::domain_error("constexpr ^ needs an integer exponent"); }
+                double v{1.0};
+                for (long long i{}; i < (n < 0 ? -n : n); ++i) { v *= l; }
+                return n < 0 ? 1.0 / v : v;
+            }
+            return std::pow(l, r);
+        case Opcode::mod:
+            if (std::is_constant_evaluated()) {
+                if (r == zero_) { return std::numeric_limits<double>::quiet_NaN(); }
+                return l - static_cast<double>(static_cast<long long>(l / r)) * r;
+            }
+            return std::fmod(l, r);
+        case Opcode::push:
+        case Opcode::load: break;
+        }
+        return zero_;
+    }
+
+    struct Instr {
+        Opcode code{Opcode::push};
+        double value{}; // push 使用
+        size_t var{};   // load 使用，变量下标
+    };
+
+    // 批量求值的按列内核，编译器可以将 + - * / 向量化
+    namespace kernel {
+        inline void add(double *a, const double *b, size_t n) {
+            for (size_t i{}; i < n; ++i) { a[i] = a[i] + b[i]; }
+        }
+        inline void sub(double *a, const double *b, size_t n) {
+            for (size_t i{}; i < n; ++i) { a[i] = a[i] - b[i]; }
+        }
+        inline void mul(double *a, const double *b, size_t n) {
+            for (size_t i{}; i < n; ++i) { a[i] = a[i] * b[i]; }
+        }
+        inline void div(double *a, const double *b, size_t n) {
+            for (size_t i{}; i < n; ++i) { a[i] = b[i] == zero_ ? inf_ : a[i] / b[i]; }
+        }
+        // ^ 和 % 调用 libm，逐个标量计算
+        inline void scalar(Opcode op, double *a, const double *b, size_t n) {
+            for (size_t i{}; i < n; ++i) { a[i] = apply(op, a[i], b[i]); }
+        }
+    } // namespace kernel
+
+    // 编译一次、多次求值的 RPN 字节码
+    // 短表达式的字节码不分配堆内存，也可以作为 constexpr 常量保留到运行期
+    class Program {
+        small_vector<Instr, 16> code_{};
+        size_t depth_{}; // 求值所需的最大栈深度
+        size_t vars_{};  // 变量个数
+
+      public:
+        static constexpr size_t max_depth{64};
+        static constexpr size_t batch_rows{256}; // 批量求值时每块的行数
+
+        // 栈深度在编译期就已确定：操作数不足时直接折叠为 op(0, 0) 常量
+        // vars 中的名字编译为按下标读取的变量，无法识别的记号与 RPN::op() 一样被忽略
+        static constexpr auto compile(string_view expr, std::initializer_list<string_view> vars = {}) -> Program {
+            Program p{};
+            size_t depth{};
+            while (!expr.empty()) {
+                const auto b{expr.find_first_not_of(" \t\r\n")};
+                if (b == string_view::npos) { break; }
+                expr.remove_prefix(b);
+                const auto token{expr.substr(0, expr.find_first_of(" \t\r\n"))};
+                expr.remove_prefix(token.size());
+
+                if (is_numeric(token)) {
+                    p.code_.push_back({Opcode::push, parse_number(token)});
+                    ++depth;
+                } else if (const auto it{std::find(vars.begin(), vars.end(), token)}; it != vars.end()) {
+                    p.code_.push_back({Opcode::load, zero_, static_cast<size_t>(it - vars.begin())});
+                    ++depth;
+                } else if (const auto op{to_opcode(token)}; op) {
+                    if (depth < 2) {
+                        p.code_.push_back({Opcode::push, apply(*op, zero_, zero_)});
+                        ++depth;
+                    } else {
+                        p.code_.push_back({*op, zero_});
+                        --depth;
+                    }
+                }
+                p.depth_ = std::max(p.depth_, depth);
+            }
+            if (p.depth_ > max_depth) { throw std::length_error("RPN expression too deep"); }
+            p.vars_ = vars.size();
+            return p;
+        }
+
+        [[nodiscard]] constexpr auto code() const -> std::span<const Instr> { return code_; }
+
+        // 在固定大小的栈上解释执行，返回栈顶，空栈返回 0
+        [[nodiscard]] constexpr auto eval(std::span<const double> vars = {}) const -> double {
+            if (vars.size() < vars_) { throw std::invalid_argument("missing RPN variables"); }
+            std::array<double, max_depth> st{};
+            size_t sp{};
+            for (const auto &in : code_) {
+                if (in.code == Opcode::push) {
+                    st[sp++] = in.value;
+                } else if (in.code == Opcode::load) {
+                    st[sp++] = vars[in.var];
+                } else {
+                    --sp;
+                    st[sp - 1] = apply(in.code, st[sp - 1], st[sp]);
+                }
+            }
+            return sp == 0 ? zero_ : st[sp - 1];
+        }
+
+        // 对整列求值：cols[i] 是第 i 个变量的列，结果写入 out
+        // 每 batch_rows 行为一块，栈中的每一项都是一块连续的列数据
+        void eval_batch(std::span<const std::span<const double>> cols, std::span<double> out) const {
+            if (cols.size() < vars_) { throw std::invalid_argument("missing RPN variables"); }
+            for (const auto &c : cols.first(vars_)) {
+                if (c.size() < out.size()) { throw std::invalid_argument("RPN column too short"); }
+            }
+
+            std::vector<double> st(std::max<size_t>(depth_, 1) * batch_rows);
+            for (size_t row{}; row < out.size(); row += batch_rows) {
+                const size_t n{std::min(batch_rows, out.size() - row)};
+                size_t sp{};
+                for (const auto &in : code_) {
+                    double *top{st.data() + sp * batch_rows};
+                    if (in.code == Opcode::push) {
+                        std::fill_n(top, n, in.value);
+                        ++sp;
+                        continue;
+                    }
+                    if (in.code == Opcode::load) {
+                        std::copy_n(cols[in.var].data() + row, n, top);
+                        ++sp;
+                        continue;
+                    }
+                    --sp;
+                    double *a{top - 2 * batch_rows};
+                    const double *b{top - batch_rows};
+                    switch (in.code) {
+                    case Opcode::add: kernel::add(a, b, n); break;
+                    case Opcode::sub: kernel::sub(a, b, n); break;
+                    case Opcode::mul: kernel::mul(a, b, n); break;
+                    case Opcode::div: kernel::div(a, b, n); break;
+                    default: kernel::scalar(in.code, a, b, n); break;
+                    }
+                }
+                if (sp == 0) {
+                    std::fill_n(out.data() + row, n, zero_);
+                } else {
+                    std::copy_n(st.data() + (sp - 1) * batch_rows, n, out.data() + row);
+                }
+            }
+        }
+    };
+
+    constexpr auto rpn_eval(string_view expr) -> double {
+        return Program::compile(expr).eval();
+    }
+} // namespace ez
+
+// 编译期已知的表达式在编译时求值
+static_assert(ez::rpn_eval("9 6 * 2 3 * +") == 60.0);
+static_assert(ez::rpn_eval("2 10 ^ 1 /") == 1024.0);
+static_assert(ez::rpn_eval("7 2 % 1.5 +") == 2.5);
+static_assert(ez::Program::compile("x y * 1 +", {"x", "y"}).eval(std::array{3.0, 4.0}) == 13.0);
+
+// 只有标识符可以作为变量名，运算符和数字不能被赋值
+static_assert(ez::split_assignment("x_1=3")->first == "x_1");
+static_assert(!ez::split_assignment("+=3") && !ez::split_assignment("*=2") && !ez::split_assignment("^=1"));
+static_assert(!ez::split_assignment("2=3") && !ez::split_assignment("x=") && !ez::split_assignment("x=y"));
+
+// 编译结果本身也是常量，运行期只剩求值
+constexpr auto poly{ez::Program::compile("x x * 2 x * + 1 +", {"x"})};
+static_assert(poly.code().size() == 9 && poly.eval(std::array{3.0}) == 16.0);
 
 class RPN {
     std::deque<double> deq_{};
-    static constexpr double zero_{0.0};
-    static constexpr double inf_{std::numeric_limits<double>::infinity()};
+    ez::string_map<double> vars_{}; // 透明比较器，按 string_view 查找不构造 std::string
+    static constexpr double zero_{ez::zero_};
 
     auto pop_get2() -> std::pair<double, double> {
         if (deq_.size() < 2) {
@@ -25,50 +315,61 @@ class RPN {
         return {v2, v1};
     }
 
-    // Finds range-based for loops that can be replaced by a call to std::any_of or std::all_of.
-    static auto is_numeric(const string &s) -> bool {
-        for (const char c : s) {
-            if (c != '.' && (std::isdigit(c) == 0)) {
-                return false;
-            }
+    auto optor(string_view op) {
+        const auto code{ez::to_opcode(op)};
+        if (!code) {
+            EZ_TRACE_COUNT("3.11/unknown", 1);
+            return zero_;
         }
-        return true;
-    }
-
-    auto optor(const string &op) {
-        std::map<string, double (*)(double, double)> opmap{
-            {"+", [](double l, double r) { return l + r; }},
-            {"-", [](double l, double r) { return l - r; }},
-            {"*", [](double l, double r) { return l * r; }},
-            {"/", [](double l, double r) { return l / r; }},
-            {"^", [](double l, double r) { return pow(l, r); }},
-            {"%", [](double l, double r) { return fmod(l, r); }},
-        };
-        if (opmap.find(op) == opmap.end()) { return zero_; }
+        EZ_TRACE_COUNT("3.11/operator", 1);
 
         auto [l, r] = pop_get2();
-
-        if (op == "/" && r == zero_) {
-            deq_.push_front(inf_);
-        } else {
-            deq_.push_front(opmap.at(op)(l, r));
-        }
-
+        deq_.push_front(ez::apply(*code, l, r));
         return deq_.front();
     }
 
   public:
-    auto op(const string &s) -> double {
-        if (is_numeric(s)) {
-            double v{std::stod(s, nullptr)};
+    // name=value 形式的记号设置变量，不改变栈
+    auto op(string_view s) -> double {
+        if (const auto assign{ez::split_assignment(s)}) {
+            const double v{ez::parse_number(assign->second)};
+            set_var(assign->first, v);
+            return v;
+        }
+        if (ez::is_numeric(s)) {
+            EZ_TRACE_COUNT("3.11/push", 1);
+            double v{ez::parse_number(s)};
             deq_.push_front(v);
             return v;
         }
+        if (auto it{vars_.find(s)}; it != vars_.end()) {
+            EZ_TRACE_COUNT("3.11/load", 1);
+            deq_.push_front(it->second);
+            return it->second;
+        }
         return optor(s);
     }
 
+    // 设置变量后，op() 遇到该名字时压入它的值
+    void set_var(string_view name, double v) {
+        if (auto it{vars_.find(name)}; it != vars_.end()) {
+            it->second = v;
+        } else {
+            vars_.emplace(name, v);
+        }
+    }
+
     void clear() { deq_.clear(); }
 
+    // 清空栈和变量
+    void reset() {
+        deq_.clear();
+        vars_.clear();
+    }
+
+    // 栈顶的值，即最近一次计算的结果；栈为空时为 0
+    [[nodiscard]] auto top() const -> double { return deq_.empty() ? zero_ : deq_.front(); }
+
     [[nodiscard]] auto get_stack_string() const -> string {
         string s{};
         for (auto v : deq_) {
@@ -78,13 +379,473 @@ class RPN {
     }
 };
 
-auto main() -> int {
+// 并发求值服务：读取方按行读入表达式，工作线程各自复用一个 RPN 对象求值，写出方按输入顺序输出结果
+// 任务队列和重排窗口都有上限，下游处理不过来时读取方阻塞，内存占用不随输入增长
+namespace ez {
+    using clock = std::chrono::steady_clock;
+
+    template <typename T>
+    class BoundedQueue {
+        std::deque<T> items_{};
+        size_t capacity_{};
+        bool closed_{};
+        std::mutex mtx_{};
+        std::condition_variable not_full_{};
+        std::condition_variable not_empty_{};
+
+      public:
+        explicit BoundedQueue(size_t capacity) : capacity_{std::max<size_t>(1, capacity)} {}
+
+        // 队列满时等待
+        void push(T v) {
+            std::unique_lock lock{mtx_};
+            not_full_.wait(lock, [&] { return items_.size() < capacity_; });
+            items_.push_back(std::move(v));
+            lock.unlock();
+            not_empty_.notify_one();
+        }
+
+        // 队列为空时等待；关闭且取完后返回 nullopt
+        auto pop() -> std::optional<T> {
+            std::unique_lock lock{mtx_};
+            not_empty_.wait(lock, [&] { return !items_.empty() || closed_; });
+            if (items_.empty()) { return std::nullopt; }
+            T v{std::move(items_.front())};
+            items_.pop_front();
+            lock.unlock();
+            not_full_.notify_one();
+            return v;
+        }
+
+        void close() {
+            {
+                const std::scoped_lock lock{mtx_};
+                closed_ = true;
+            }
+            not_empty_.notify_all();
+        }
+    };
+
+    // 按序号重排结果的环形窗口：最多 window 个已分配但未输出的序号，acquire() 在窗口满时等待
+    class ReorderBuffer {
+        struct Slot {
+            string value{};
+            clock::time_point start{};
+            bool ready{};
+        };
+
+        std::vector<Slot> slots_{};
+        size_t next_{}; // 下一个要输出的序号
+        size_t end_{};  // 已分配的序号个数
+        bool closed_{};
+        std::mutex mtx_{};
+        std::condition_variable space_cv_{};
+        std::condition_variable ready_cv_{};
+
+        auto slot(size_t seq) -> Slot & { return slots_[seq % slots_.size()]; }
+
+      public:
+        explicit ReorderBuffer(size_t window) : slots_(std::max<size_t>(1, window)) {}
+
+        auto acquire() -> size_t {
+            std::unique_lock lock{mtx_};
+            space_cv_.wait(lock, [&] { return end_ - next_ < slots_.size(); });
+            return end_++;
+        }
+
+        void put(size_t seq, string value, clock::time_point start) {
+            bool wake{};
+            {
+                const std::scoped_lock lock{mtx_};
+                slot(seq) = {std::move(value), start, true};
+                wake = seq == next_;
+            }
+            if (wake) { ready_cv_.notify_one(); }
+        }
+
+        // 不再分配新的序号
+        void close() {
+            {
+                const std::scoped_lock lock{mtx_};
+                closed_ = true;
+            }
+            ready_cv_.notify_one();
+        }
+
+        // 按序号顺序对每个结果调用 emit(value, start)，等待下一个结果前调用 idle()；全部输出且已关闭时返回
+        template <typename Emit, typename Idle>
+        void drain(Emit &&emit, Idle &&idle) {
+            std::unique_lock lock{mtx_};
+            while (true) {
+                if (auto &s{slot(next_)}; s.ready) {
+                    const string value{std::move(s.value)};
+                    const auto start{s.start};
+                    s.ready = false;
+                    ++next_;
+                    lock.unlock();
+                    space_cv_.notify_one();
+                    emit(string_view{value}, start);
+                    lock.lock();
+                    continue;
+                }
+                if (closed_ && next_ == end_) { return; }
+                lock.unlock();
+                idle();
+                lock.lock();
+                ready_cv_.wait(lock, [&] { return slot(next_).ready || (closed_ && next_ == end_); });
+            }
+        }
+    };
+
+    struct ServeOptions {
+        size_t threads{std::max(1U, std::thread::hardware_concurrency())};
+        size_t queue{1024};  // 任务队列容量
+        size_t window{4096}; // 重排窗口，即同时在处理中的表达式上限
+    };
+} // namespace ez
+
+// 按空白切分一行表达式，逐个记号交给 rpn，返回栈顶
+// 每行相互独立：服务模式中各行可能由不同线程的 RPN 求值，所以行内设置的变量不带到下一行
+auto eval_line(RPN &rpn, string_view line) -> double {
+    rpn.reset();
+    while (true) {
+        const auto b{line.find_first_not_of(" \t\r")};
+        if (b == string_view::npos) { break; }
+        line.remove_prefix(b);
+        const auto token{line.substr(0, line.find_first_of(" \t\r"))};
+        rpn.op(token);
+        line.remove_prefix(token.size());
+    }
+    return rpn.top();
+}
+
+// read(line, start) 读入下一行及其开始计时的时刻，没有更多输入时返回 false
+// 结果按输入顺序交给 sink.emit(result, latency)，写出方等待下一个结果前调用 sink.flush()；返回处理的行数
+template <typename Read, typename Sink>
+auto serve(Read &&read, Sink &sink, const ez::ServeOptions &opt) -> size_t {
+    ez::BoundedQueue<std::tuple<size_t, string, ez::clock::time_point>> jobs{opt.queue};
+    ez::ReorderBuffer results{opt.window};
+    std::jthread writer{[&] {
+        results.drain([&](string_view value, ez::clock::time_point start) { sink.emit(value, ez::clock::now() - start); },
+                      [&] { sink.flush(); });
+        sink.flush();
+    }};
+
+    size_t lines{};
+    {
+        std::vector<std::jthread> workers{};
+        try {
+            for (size_t t{}; t < opt.threads; ++t) {
+                workers.emplace_back([&] {
+                    RPN rpn{}; // 每个线程一个求值器，变量表和栈的内存在各行之间复用
+                    while (auto job{jobs.pop()}) {
+                        auto &[seq, line, start]{*job};
+                        results.put(seq, format("{}", eval_line(rpn, line)), start);
+                    }
+                });
+            }
+            string line{};
+            for (ez::clock::time_point start{}; read(line, start); ++lines) {
+                jobs.push({results.acquire(), std::move(line), start});
+                line = string{};
+            }
+        } catch (...) {
+            // 读取失败时也要关闭队列和窗口，否则工作线程和写出方一直等待，析构 jthread 时无法 join
+            jobs.close();
+            workers.clear();
+            results.close();
+            throw;
+        }
+        jobs.close();
+    }
+    results.close();
+    return lines;
+}
+
+// 输出到 FILE*，标准输出和套接字连接共用
+struct FileSink {
+    std::FILE *out{};
+
+    void emit(string_view value, ez::clock::duration) {
+        std::fwrite(value.data(), 1, value.size(), out);
+        std::fputc('\n', out);
+    }
+    void flush() { std::fflush(out); }
+};
+
+void serve_stdin(const ez::ServeOptions &opt) {
+    FileSink sink{stdout};
+    serve(
+        [](string &line, ez::clock::time_point &start) {
+            if (!std::getline(cin, line)) { return false; }
+            start = ez::clock::now();
+            return true;
+        },
+        sink, opt);
+}
+
+#ifdef EZ_UNIX_SOCKET
+// 在 Unix 套接字上依次接受连接，每个连接与 stdin 模式相同：一行一个表达式，按顺序返回结果
+auto serve_socket(const string &path, const ez::ServeOptions &opt) -> int {
+    sockaddr_un addr{};
+    if (path.size() >= sizeof(addr.sun_path)) {
+        std::cerr << format("socket path too long: {}\n", path);
+        return 1;
+    }
+    addr.sun_family = AF_UNIX;
+    std::copy(path.begin(), path.end(), addr.sun_path);
+    // 只删除上次运行留下的套接字文件，同名的普通文件不动
+    if (struct stat st {}; ::lstat(path.c_str(), &st) == 0) {
+        if (!S_ISSOCK(st.st_mode)) {
+            std::cerr << format("{} exists and is not a socket\n", path);
+            return 1;
+        }
+        ::unlink(path.c_str());
+    }
+    const int fd{::socket(AF_UNIX, SOCK_STREAM, 0)};
+    if (fd < 0 || ::bind(fd, reinterpret_cast<const sockaddr *>(&addr), sizeof(addr)) != 0 || ::listen(fd, 16) != 0) {
+        std::perror("socket");
+        if (fd >= 0) { ::close(fd); }
+        return 1;
+    }
+    // 客户端中途断开时写入返回 EPIPE，而不是以 SIGPIPE 结束整个服务
+    std::signal(SIGPIPE, SIG_IGN);
+    std::cerr << format("listening on {}\n", path);
+    for (int conn{}; (conn = ::accept(fd, nullptr, nullptr)) >= 0;) {
+        std::FILE *in{::fdopen(conn, "r")};
+        if (in == nullptr) {
+            std::perror("fdopen");
+            ::close(conn);
+            continue;
+        }
+        const int out_fd{::dup(conn)};
+        std::FILE *out{out_fd < 0 ? nullptr : ::fdopen(out_fd, "w")};
+        if (out == nullptr) {
+            std::perror("fdopen");
+            if (out_fd >= 0) { ::close(out_fd); }
+            std::fclose(in);
+            continue;
+        }
+        FileSink sink{out};
+        char *buf{};
+        size_t cap{};
+        const size_t n{serve(
+            [&](string &line, ez::clock::time_point &start) {
+                const auto len{::getline(&buf, &cap, in)};
+                if (len < 0) { return false; }
+                line.assign(buf, static_cast<size_t>(len));
+                if (line.ends_with('\n')) { line.pop_back(); }
+                start = ez::clock::now();
+                return true;
+            },
+            sink, opt)};
+        std::free(buf);
+        std::fclose(sink.out);
+        std::fclose(in);
+        std::cerr << format("connection closed after {} expressions\n", n);
+    }
+    ::close(fd);
+    return 0;
+}
+#endif
+
+// 本地负载生成：count 个随机表达式经过 serve()，rate 为每秒提交的个数（0 表示不限速）
+// 限速时从计划提交的时刻开始计时，读取方被背压阻塞的时间也计入延迟
+auto load_test(size_t count, double rate, const ez::ServeOptions &opt) -> bool {
+    std::mt19937_64 rng{42};
+    std::uniform_int_distribution<int> num{1, 999};
+    std::uniform_int_distribution<size_t> len{2, 8};
+    constexpr std::array ops{'+', '-', '*', '/', '^', '%'};
+    std::vector<string> exprs(count);
+    for (auto &e : exprs) {
+        e = format("{}", num(rng));
+        for (size_t i{1}, n{len(rng)}; i < n; ++i) { e += format(" {} {}", num(rng) % 10 + 1, ops[rng() % ops.size()]); }
+    }
+
+    std::vector<string> expected(count);
+    RPN rpn{};
+    for (size_t i{}; i < count; ++i) { expected[i] = format("{}", eval_line(rpn, exprs[i])); }
+
+    struct Collect {
+        std::vector<string> results{};
+        std::vector<double> latency_us{};
+
+        void emit(string_view value, ez::clock::duration d) {
+            results.emplace_back(value);
+            latency_us.push_back(std::chrono::duration<double, std::micro>(d).count());
+        }
+        void flush() {}
+    } sink{};
+    sink.results.reserve(count);
+    sink.latency_us.reserve(count);
+
+    const auto t0{ez::clock::now()};
+    const auto interval{rate > 0 ? std::chrono::duration_cast<ez::clock::duration>(std::chrono::duration<double>(1.0 / rate))
+                                 : ez::clock::duration{}};
+    size_t next{};
+    serve(
+        [&](string &line, ez::clock::time_point &start) {
+            if (next == count) { return false; }
+            start = ez::clock::now();
+            if (rate > 0) {
+                start = t0 + interval * static_cast<ez::clock::rep>(next);
+                std::this_thread::sleep_until(start);
+            }
+            line = exprs[next++];
+            return true;
+        },
+        sink, opt);
+    const double secs{std::chrono::duration<double>(ez::clock::now() - t0).count()};
+
+    auto &lat{sink.latency_us};
+    std::ranges::sort(lat);
+    auto pct = [&](double p) { return lat.empty() ? 0.0 : lat[std::min(lat.size() - 1, static_cast<size_t>(p * static_cast<double>(lat.size())))]; };
+    const bool ok{sink.results == expected};
+    cout << format("threads {:>2}  {:>10.0f} expr/s  p50 {:>8.1f} us  p99 {:>8.1f} us  p99.9 {:>8.1f} us  max {:>8.1f} us  "
+                   "results {}\n",
+                   opt.threads, static_cast<double>(count) / secs, pct(0.5), pct(0.99), pct(0.999),
+                   lat.empty() ? 0.0 : lat.back(), ok ? "in order" : "DIFFER");
+    return ok;
+}
+
+// 对比逐记号求值与编译一次、多次求值
+void bench(ez::bench::Runner &runner, string_view expr, size_t n) {
+    std::vector<string> tokens{};
+    std::istringstream iss{string{expr}};
+    for (string t{}; iss >> t;) { tokens.push_back(t); }
+
+    runner.run("3.11/per-token RPN", n, [&] {
+        RPN rpn;
+        double sink{};
+        for (size_t i{}; i < n; ++i) {
+            rpn.clear();
+            double v{};
+            for (const auto &t : tokens) { v = rpn.op(t); }
+            sink += v;
+        }
+        return sink;
+    });
+    const auto prog{ez::Program::compile(expr)};
+    runner.run("3.11/compiled", n, [&] {
+        double sink{};
+        for (size_t i{}; i < n; ++i) { sink += prog.eval(); }
+        return sink;
+    });
+}
+
+// 对比逐行标量求值与按列批量求值
+void bench_batch(ez::bench::Runner &runner, string_view expr, size_t rows) {
+    std::mt19937_64 rng{42};
+    std::uniform_real_distribution<double> dist{-100.0, 100.0};
+    std::vector<double> x(rows);
+    std::vector<double> y(rows);
+    for (size_t i{}; i < rows; ++i) {
+        x[i] = dist(rng);
+        y[i] = dist(rng);
+    }
+    std::vector<double> scalar_out(rows);
+    std::vector<double> batch_out(rows);
+    const auto prog{ez::Program::compile(expr, {"x", "y"})};
+
+    runner.run("3.11/scalar rows", rows, [&] {
+        for (size_t i{}; i < rows; ++i) {
+            const std::array<double, 2> vars{x[i], y[i]};
+            scalar_out[i] = prog.eval(vars);
+        }
+        return scalar_out.back();
+    });
+    const std::array<std::span<const double>, 2> cols{x, y};
+    runner.run("3.11/batch rows", rows, [&] {
+        prog.eval_batch(cols, batch_out);
+        return batch_out.back();
+    });
+
+    const bool same{std::ranges::equal(scalar_out, batch_out, [](double a, double b) {
+        return a == b || (std::isnan(a) && std::isnan(b));
+    })};
+    std::cerr << format("batch results {}\n", same ? "match" : "DIFFER");
+}
+
+auto main(int argc, char *argv[]) -> int {
+    if (ez::bench::requested(argc, argv)) {
+        ez::bench::Runner runner{argc, argv, {.warmup = 1, .runs = 5}};
+        bench(runner, runner.arg(0, "9 6 * 2 3 * + 4.5 / 3 ^ 7 %"), 1'000'000);
+        bench_batch(runner, runner.arg(1, "x y * 2 x * + y 3 - /"), 10'000'000);
+        return 0;
+    }
+
+    constexpr size_t max_threads{256};
+    constexpr size_t max_queue{size_t{1} << 20};
+    constexpr size_t max_load{size_t{1} << 32};
+    // 解析 [1, hi] 内的计数，失败时输出用法并返回 false
+    auto count_arg = [](string_view name, string_view v, size_t hi, size_t &out) {
+        const auto n{ez::parse_size(v, 1, hi)};
+        if (!n) {
+            std::cerr << format("{}: expected 1..{}, got \"{}\"\n", name, hi, v);
+            return false;
+        }
+        out = *n;
+        return true;
+    };
+
+    ez::ServeOptions opt{};
+    bool serve_mode{};
+    std::optional<size_t> load{};
+    double rate{};
+    string socket_path{};
+    for (int i{1}; i < argc; ++i) {
+        const string_view arg{argv[i]};
+        const bool has_value{i + 1 < argc && !string_view{argv[i + 1]}.starts_with("--")};
+        if (arg == "--serve") {
+            serve_mode = true;
+        } else if (arg == "--socket" && has_value) {
+            socket_path = argv[++i];
+        } else if (arg == "--threads" && has_value) {
+            if (!count_arg(arg, argv[++i], max_threads, opt.threads)) { return 1; }
+        } else if (arg == "--queue" && has_value) {
+            if (!count_arg(arg, argv[++i], max_queue, opt.queue)) { return 1; }
+            opt.window = std::max(opt.window, opt.queue);
+        } else if (arg == "--load") {
+            size_t n{1'000'000};
+            if (has_value && !count_arg(arg, argv[++i], max_load, n)) { return 1; }
+            load = n;
+        } else if (arg == "--rate" && has_value) {
+            const string_view v{argv[++i]};
+            const auto [end, ec]{std::from_chars(v.data(), v.data() + v.size(), rate)};
+            if (ec != std::errc{} || end != v.data() + v.size() || !(rate >= 0)) {
+                std::cerr << format("--rate: expected a non-negative number, got \"{}\"\n", v);
+                return 1;
+            }
+        }
+    }
+    if (load) { return load_test(*load, rate, opt) ? 0 : 1; }
+    if (serve_mode) {
+        if (socket_path.empty()) {
+            serve_stdin(opt);
+            return 0;
+        }
+#ifdef EZ_UNIX_SOCKET
+        return serve_socket(socket_path, opt);
+#else
+        std::cerr << "unix sockets are not supported on this platform\n";
+        return 1;
+#endif
+    }
+
     RPN rpn;
     for (string o{}; cin >> o;) {
-        rpn.op(o);
+        {
+            EZ_TRACE_SCOPE("3.11/op");
+            rpn.op(o);
+        }
+        EZ_TRACE_SCOPE("3.11/print");
         auto stack_str{rpn.get_stack_string()};
         cout << format("{}: {}\n", o, stack_str);
     }
 }
 
 // "9 6 * 2 3 * +" | .\build\windows\x64\release\ch03_3.11.exe
+// 变量："x=3 y=4 x y * x +" | .\build\windows\x64\release\ch03_3.11.exe
+// .\build\windows\x64\release\ch03_3.11.exe --bench "1 2 + 3 *" "x y + 2 ^"
+// 服务模式，一行一个表达式：ch03_3.11 --serve [--threads N] [--queue N] [--socket /tmp/rpn.sock]
+// 本地负载测试：ch03_3.11 --load [count] [--rate expr/s] [--threads N]
@@ -7,15 +7,30 @@
  */
 
 #include <algorithm>
+#include <array>
 #include <cctype>
+#include <cstdint>
+#include <cstdio>
 #include <format>
+#include <functional>
 #include <iostream>
+#include <iterator>
 #include <map>
+#include <memory>
+#include <random>
 #include <regex>
+#include <sstream>
 #include <string>
+#include <string_view>
+#include <thread>
 #include <utility>
 #include <vector>
 
+#include "ez/args.h"
+#include "ez/bench.h"
+#include "ez/small_vector.h"
+#include "ez/trace.h"
+
 using std::cin;
 using std::cout;
 using std::format;
@@ -25,55 +40,405 @@ using std::regex;
 using std::smatch;
 using std::sregex_iterator;
 using std::string;
+using std::string_view;
 using std::vector;
 
 namespace ranges = std::ranges;
 
 namespace ez {
     constexpr const char *re{"(\\w+)"};
-}
+    constexpr size_t top_n{20};
+    constexpr size_t chunk_size{1 << 20}; // 流式模式每次读取 1 MiB
+
+    struct WordStats {
+        size_t total{};
+        size_t unique{};
+        vector<pair<string, size_t>> top{}; // 按次数降序、单词升序排列的前 top_n 项
+    };
+
+    // 次数降序，次数相同时按单词升序
+    constexpr auto by_count_then_word = [](const auto &a, const auto &b) {
+        if (a.second != b.second) {
+            return (a.second > b.second);
+        }
+        return (a.first < b.first);
+    };
 
-auto main() -> int {
-    map<string, int> wordmap{};
-    vector<pair<string, int>> wordvec{};
-    regex word_re(ez::re);
-    size_t total_words{};
+    // 只对前 n 项做部分排序，不必对整个 wordvec 排序
+    template <typename V>
+    auto top_of(V &wordvec, size_t n) -> vector<pair<string, size_t>> {
+        EZ_TRACE_SCOPE("3.12/sort");
+        const auto mid{wordvec.begin() + static_cast<std::ptrdiff_t>(std::min(n, wordvec.size()))};
+        std::partial_sort(wordvec.begin(), mid, wordvec.end(), by_count_then_word);
+        vector<pair<string, size_t>> top{};
+        top.reserve(static_cast<size_t>(mid - wordvec.begin()));
+        for (auto it{wordvec.begin()}; it != mid; ++it) {
+            top.emplace_back(string{it->first}, it->second);
+        }
+        return top;
+    }
 
-    for (string s{}; cin >> s;) {
-        auto words_begin{sregex_iterator(s.begin(), s.end(), word_re)};
-        auto words_end{sregex_iterator()};
+    // 原始实现：regex 匹配 cin 读入的每个字符串
+    auto count_regex(std::istream &in) -> WordStats {
+        map<string, size_t, std::less<>> wordmap{}; // 透明比较器，已有的单词按 string_view 查找，不再复制
+        vector<pair<string, size_t>> wordvec{};
+        regex word_re(re);
+        WordStats stats{};
+        string word_str{}; // 复用的小写缓冲区
 
-        for (auto r_it{words_begin}; r_it != words_end; ++r_it) {
-            const smatch &match{*r_it};
-            auto word_str{match.str()};
+        for (string s{}; in >> s;) {
+            EZ_TRACE_SCOPE("3.12/regex token");
+            auto words_begin{sregex_iterator(s.begin(), s.end(), word_re)};
+            auto words_end{sregex_iterator()};
 
-            ranges::transform(word_str, word_str.begin(),
-                              [](unsigned char c) { return tolower(c); });
+            for (auto r_it{words_begin}; r_it != words_end; ++r_it) {
+                const smatch &match{*r_it};
+                word_str.assign(match[0].first, match[0].second);
 
-            auto [map_it, result] = wordmap.try_emplace(word_str, 0);
-            auto &[w, count] = *map_it;
-            ++total_words;
-            ++count;
+                ranges::transform(word_str, word_str.begin(),
+                                  [](unsigned char c) { return tolower(c); });
+
+                ++stats.total;
+                if (auto it{wordmap.find(string_view{word_str})}; it != wordmap.end()) {
+                    ++it->second;
+                } else {
+                    wordmap.emplace(word_str, 1);
+                }
+            }
         }
+
+        EZ_TRACE_COUNT("3.12/words", stats.total);
+        stats.unique = wordmap.size();
+        wordvec.reserve(stats.unique);
+        ranges::move(wordmap, back_inserter(wordvec));
+        stats.top = top_of(wordvec, top_n);
+        return stats;
     }
 
-    auto unique_words = wordmap.size();
-    wordvec.reserve(unique_words);
-    ranges::move(wordmap, back_inserter(wordvec));
-    ranges::sort(wordvec, [](const auto &a, const auto &b) {
-        if (a.second != b.second) {
-            return (a.second > b.second);
+    // 字符分类表：与 \w 相同的 [0-9A-Za-z_] 映射为小写形式，其余字符映射为 0
+    constexpr auto word_table{[] {
+        std::array<unsigned char, 256> t{};
+        for (int c{'0'}; c <= '9'; ++c) { t[c] = static_cast<unsigned char>(c); }
+        for (int c{'a'}; c <= 'z'; ++c) { t[c] = static_cast<unsigned char>(c); }
+        for (int c{'A'}; c <= 'Z'; ++c) { t[c] = static_cast<unsigned char>(c - 'A' + 'a'); }
+        t['_'] = '_';
+        return t;
+    }()};
+
+    // 分块分配的字符串池，已存储的 string_view 在整个生命周期内保持有效
+    class Arena {
+        static constexpr size_t block_size_{1 << 16};
+        vector<std::unique_ptr<char[]>> blocks_{};
+        char *cur_{nullptr};
+        size_t left_{0};
+
+      public:
+        auto store(string_view s) -> string_view {
+            if (s.size() > left_) {
+                const size_t n{std::max(block_size_, s.size())};
+                blocks_.push_back(std::make_unique_for_overwrite<char[]>(n));
+                cur_ = blocks_.back().get();
+                left_ = n;
+            }
+            char *p{cur_};
+            std::copy(s.begin(), s.end(), p);
+            cur_ += s.size();
+            left_ -= s.size();
+            return {p, s.size()};
         }
-        return (a.first < b.first);
+    };
+
+    // 以 arena 中的 string_view 为键的开放寻址（线性探测）哈希表
+    class WordTable {
+        struct Slot {
+            string_view word{};
+            uint64_t hash{};
+            size_t count{}; // 0 表示空槽
+        };
+
+        vector<Slot> slots_{vector<Slot>(1024)};
+        size_t size_{};
+        Arena arena_{};
+
+        void grow() {
+            EZ_TRACE_COUNT("3.12/rehash", 1);
+            vector<Slot> old(slots_.size() * 2);
+            old.swap(slots_);
+            const size_t mask{slots_.size() - 1};
+            for (const auto &s : old) {
+                if (s.count == 0) { continue; }
+                size_t i{s.hash & mask};
+                while (slots_[i].count != 0) { i = (i + 1) & mask; }
+                slots_[i] = s;
+            }
+        }
+
+      public:
+        static auto hash(string_view w) -> uint64_t { // FNV-1a
+            uint64_t h{14695981039346656037ULL};
+            for (const unsigned char c : w) {
+                h = (h ^ c) * 1099511628211ULL;
+            }
+            return h;
+        }
+
+        void add(string_view w, uint64_t h, size_t n = 1) {
+            if ((size_ + 1) * 2 > slots_.size()) { grow(); }
+            const size_t mask{slots_.size() - 1};
+            for (size_t i{h & mask};; i = (i + 1) & mask) {
+                auto &s{slots_[i]};
+                if (s.count == 0) {
+                    s = {arena_.store(w), h, n};
+                    ++size_;
+                    return;
+                }
+                if (s.hash == h && s.word == w) {
+                    s.count += n;
+                    return;
+                }
+            }
+        }
+
+        [[nodiscard]] auto size() const -> size_t { return size_; }
+
+        // 按 (word, hash, count) 遍历所有非空槽
+        void for_each(auto &&f) const {
+            for (const auto &s : slots_) {
+                if (s.count != 0) { f(s.word, s.hash, s.count); }
+            }
+        }
+
+        [[nodiscard]] auto entries() const -> vector<pair<string_view, size_t>> {
+            vector<pair<string_view, size_t>> v{};
+            v.reserve(size_);
+            for (const auto &s : slots_) {
+                if (s.count != 0) { v.emplace_back(s.word, s.count); }
+            }
+            return v;
+        }
+    };
+
+    // 流式分词计数器：单词可以跨越 feed() 的块边界
+    class WordCounter {
+        WordTable table_{};
+        string word_{};
+        size_t total_{};
+
+        void flush() {
+            table_.add(word_, WordTable::hash(word_));
+            ++total_;
+            word_.clear();
+        }
+
+      public:
+        [[nodiscard]] auto table() const -> const WordTable & { return table_; }
+        [[nodiscard]] auto total() const -> size_t { return total_; }
+
+        void feed(string_view chunk) {
+            EZ_TRACE_SCOPE("3.12/tokenize+count");
+            for (const unsigned char c : chunk) {
+                if (const auto lc{word_table[c]}; lc != 0) {
+                    word_.push_back(static_cast<char>(lc));
+                } else if (!word_.empty()) {
+                    flush();
+                }
+            }
+        }
+
+        void close() {
+            if (!word_.empty()) { flush(); }
+            EZ_TRACE_COUNT("3.12/words", total_);
+        }
+
+        auto finish() -> WordStats {
+            close();
+            auto wordvec{table_.entries()};
+            return {total_, table_.size(), top_of(wordvec, top_n)};
+        }
+    };
+
+    auto count_stream(std::FILE *in) -> WordStats {
+        WordCounter counter{};
+        auto buf{std::make_unique_for_overwrite<char[]>(chunk_size)};
+        for (size_t n{}; (n = std::fread(buf.get(), 1, chunk_size, in)) != 0;) {
+            counter.feed({buf.get(), n});
+        }
+        return counter.finish();
+    }
+
+    auto read_all(std::FILE *in) -> string {
+        EZ_TRACE_SCOPE("3.12/read");
+        string data{};
+        auto buf{std::make_unique_for_overwrite<char[]>(chunk_size)};
+        for (size_t n{}; (n = std::fread(buf.get(), 1, chunk_size, in)) != 0;) {
+            data.append(buf.get(), n);
+        }
+        return data;
+    }
+
+    // 将输入切分为 n 段，切分点向后移动到单词边界，保证没有单词被截断
+    // 线程数通常很少，切分结果放在 small_vector 内部，不分配堆内存
+    auto split_on_words(string_view data, size_t n) -> small_vector<string_view, 16> {
+        auto is_word = [](char c) { return word_table[static_cast<unsigned char>(c)] != 0; };
+        small_vector<string_view, 16> parts{};
+        size_t begin{};
+        for (size_t k{1}; k <= n; ++k) {
+            size_t end{k == n ? data.size() : std::max(begin, data.size() * k / n)};
+            while (end < data.size() && end > 0 && is_word(data[end - 1]) && is_word(data[end])) {
+                ++end;
+            }
+            parts.push_back(data.substr(begin, end - begin));
+            begin = end;
+        }
+        return parts;
+    }
+
+    // 多线程计数：每个线程计数到自己的表中，再按哈希值分区归并
+    auto count_parallel(string_view data, size_t threads) -> WordStats {
+        const auto parts{split_on_words(data, threads)};
+        vector<WordCounter> counters(threads);
+        {
+            vector<std::jthread> pool{};
+            for (size_t i{}; i < threads; ++i) {
+                pool.emplace_back([&, i] {
+                    counters[i].feed(parts[i]);
+                    counters[i].close();
+                });
+            }
+        }
+
+        // 第 p 个线程只归并高位哈希落在分区 p 的单词，分区之间互不相交
+        vector<WordTable> shards(threads);
+        {
+            vector<std::jthread> pool{};
+            for (size_t p{}; p < threads; ++p) {
+                pool.emplace_back([&, p] {
+                    EZ_TRACE_SCOPE("3.12/merge");
+                    for (const auto &c : counters) {
+                        c.table().for_each([&](string_view w, uint64_t h, size_t n) {
+                            if ((h >> 32) % threads == p) { shards[p].add(w, h, n); }
+                        });
+                    }
+                });
+            }
+        }
+
+        WordStats stats{};
+        vector<pair<string_view, size_t>> wordvec{};
+        for (const auto &c : counters) { stats.total += c.total(); }
+        for (const auto &s : shards) { stats.unique += s.size(); }
+        wordvec.reserve(stats.unique);
+        for (const auto &s : shards) {
+            s.for_each([&](string_view w, uint64_t, size_t n) { wordvec.emplace_back(w, n); });
+        }
+        stats.top = top_of(wordvec, top_n);
+        return stats;
+    }
+
+    void print_stats(const WordStats &stats) {
+        cout << format("total word count: {}\n", stats.total);
+        cout << format("unique word count: {}\n", stats.unique);
+        for (const auto &[w, count] : stats.top) {
+            cout << format("{}: {}\n", count, w);
+        }
+    }
+
+    auto same_stats(const WordStats &a, const WordStats &b) -> bool {
+        return a.total == b.total && a.unique == b.unique && a.top == b.top;
+    }
+
+    // 合成语料：单词取自偏斜分布的词表，夹杂大小写和标点
+    auto synth_corpus(size_t mib) -> string {
+        std::mt19937 rng{42};
+        vector<string> vocab(50'000);
+        for (auto &w : vocab) {
+            w.resize(2 + rng() % 9);
+            for (auto &c : w) { c = static_cast<char>('a' + rng() % 26); }
+        }
+        constexpr std::array<string_view, 6> seps{" ", " ", " ", ", ", ". ", "\n"};
+        string data{};
+        data.reserve((mib << 20) + 64);
+        while (data.size() < mib << 20) {
+            const auto &w{vocab[rng() % (rng() % vocab.size() + 1)]};
+            const size_t at{data.size()};
+            data += w;
+            if (rng() % 8 == 0) { data[at] = static_cast<char>(data[at] - 'a' + 'A'); }
+            data += seps[rng() % seps.size()];
+        }
+        return data;
+    }
+} // namespace ez
+
+constexpr size_t max_threads{256};
+constexpr size_t max_mib{4096};
+
+// 输入为 "-" 时读取 stdin，否则生成指定 MiB 的合成语料，按字节数报告吞吐量
+// threads > 1 时追加 1..threads 线程的扩展性测试
+void bench(ez::bench::Runner &runner, string_view input, size_t threads) {
+    const string data{input == "-" ? ez::read_all(stdin) : ez::synth_corpus(*ez::parse_size(input, 1, max_mib))};
+    std::cerr << format("input: {:.2f} MB\n", static_cast<double>(data.size()) / 1e6);
+
+    ez::WordStats slow{};
+    ez::WordStats fast{};
+    runner.run("3.12/regex", data.size(), [&] {
+        std::istringstream iss{data};
+        slow = ez::count_regex(iss);
+        return slow.total;
     });
+    runner.run("3.12/stream", data.size(), [&] {
+        ez::WordCounter counter{};
+        for (size_t pos{}; pos < data.size(); pos += ez::chunk_size) {
+            counter.feed(string_view{data}.substr(pos, ez::chunk_size));
+        }
+        fast = counter.finish();
+        return fast.total;
+    });
+    std::cerr << format("stream results {}\n", ez::same_stats(slow, fast) ? "match" : "DIFFER");
 
-    cout << format("total word count: {}\n", total_words);
-    cout << format("unique word count: {}\n", unique_words);
+    for (size_t t{1}; threads > 1 && t <= threads; ++t) {
+        ez::WordStats par{};
+        runner.run(format("3.12/threads/{}", t), data.size(), [&] {
+            par = ez::count_parallel(data, t);
+            return par.total;
+        });
+        std::cerr << format("threads {} results {}\n", t, ez::same_stats(fast, par) ? "match" : "DIFFER");
+    }
+}
+
+// 用法：0312 [--stream] [--threads N] < file
+//       0312 --bench [MiB | -] [--threads N]
+auto main(int argc, char *argv[]) -> int {
+    bool stream{};
+    string_view input{"16"};
+    size_t threads{1};
+    for (int i{1}; i < argc; ++i) {
+        const string_view arg{argv[i]};
+        if (arg == "--threads" && i + 1 < argc) {
+            const auto t{ez::parse_size(argv[++i], 1, max_threads)};
+            if (!t) {
+                std::cerr << format("--threads: expected 1..{}, got \"{}\"\n", max_threads, argv[i]);
+                return 1;
+            }
+            threads = *t;
+        } else if (arg == "--stream") {
+            stream = true;
+        } else if (!arg.starts_with("--")) {
+            input = arg;
+        }
+    }
 
-    for (int limit{20}; auto &[w, count] : wordvec) {
-        cout << format("{}: {}\n", count, w);
-        if (--limit == 0) {
-            break;
+    if (ez::bench::requested(argc, argv)) {
+        if (input != "-" && !ez::parse_size(input, 1, max_mib)) {
+            std::cerr << format("input: expected - or 1..{} MiB, got \"{}\"\n", max_mib, input);
+            return 1;
         }
+        ez::bench::Runner runner{argc, argv, {.warmup = 0, .runs = 3}};
+        bench(runner, input, threads);
+    } else if (threads > 1) {
+        ez::print_stats(ez::count_parallel(ez::read_all(stdin), threads));
+    } else if (stream) {
+        ez::print_stats(ez::count_stream(stdin));
+    } else {
+        ez::print_stats(ez::count_regex(cin));
     }
 }
@@ -13,6 +13,9 @@
 #include <string>
 #include <vector>
 
+#include "ez/bench.h"
+#include "ez/outbuf.h"
+
 using std::cin;
 using std::cout;
 using std::endl;
@@ -27,22 +30,50 @@ void remove_value(Tc &c, const Tv &v) {
 }
 
 void print_seq(auto &r) {
-    cout << format("size({}): ", r.size());
+    auto &out{ez::out()};
+    out.print("size({}): ", r.size());
     for (auto &e : r) {
-        cout << format("{} ", e);
+        out.put<"{} ">(e);
     }
-    cout << "\n";
+    out.write("\n");
+    out.flush();
 }
 
 void print_assoc(auto &r) {
-    cout << format("size({}): ", r.size());
+    auto &out{ez::out()};
+    out.print("size({}): ", r.size());
     for (auto &[k, v] : r) {
-        cout << format("{}:{} ", k, v);
+        out.put<"{}:{} ">(k, v);
     }
-    cout << "\n";
+    out.write("\n");
+    out.flush();
 }
 
-auto main() -> int {
+void bench(ez::bench::Runner &runner) {
+    const size_t n{runner.count(0, 1'000'000)};
+    std::vector<int> vec(n);
+    std::map<int, string> m{};
+    for (size_t i{}; i < n; ++i) {
+        vec[i] = static_cast<int>(i % 10);
+        if (i < n / 10) { m.emplace(static_cast<int>(i), "x"); }
+    }
+
+    auto copy_vec = [&] { return vec; };
+    runner.run("3.3/remove_value", n, copy_vec, [](auto &v) { remove_value(v, 1); return v.size(); });
+    runner.run("3.3/std::erase", n, copy_vec, [](auto &v) { return std::erase(v, 1); });
+    runner.run("3.3/std::erase_if", n, copy_vec, [](auto &v) { return std::erase_if(v, [](auto x) { return x % 2 == 0; }); });
+    runner.run("3.3/std::erase_if(map)", m.size(), [&] { return m; }, [](auto &c) {
+        return erase_if(c, [](auto &p) { return p.first % 2 == 0; });
+    });
+}
+
+auto main(int argc, char *argv[]) -> int {
+    if (ez::bench::requested(argc, argv)) {
+        ez::bench::Runner runner{argc, argv};
+        bench(runner);
+        return 0;
+    }
+
     std::vector<int> vec{1, 2, 3, 4, 4, 3, 2, 1, 1, 2, 3, 4};
     remove_value(vec, 1);
     print_seq(vec);
@@ -6,11 +6,19 @@
  * @Description  : 常数时间内从未排序的 vector 中删除项
  */
 
+#include <algorithm>
 #include <format>
 #include <iostream>
+#include <random>
+#include <span>
 #include <string>
+#include <string_view>
 #include <utility>
 #include <vector>
+
+#include "ez/bench.h"
+#include "ez/outbuf.h"
+
 using std::cin;
 using std::cout;
 using std::endl;
@@ -18,30 +26,168 @@ using std::format;
 using std::string;
 
 void printc(auto &r) {
-    cout << format("size({}) ", r.size());
+    auto &out{ez::out()};
+    out.print("size({}) ", r.size());
     for (auto &e : r) {
-        cout << format("{} ", e);
+        out.put<"{} ">(e);
     }
-    cout << "\n";
+    out.write("\n");
+    out.flush();
 }
 
+// 用尾部元素覆盖 idx 处的元素，返回移动次数：删除的就是尾部元素时不需要移动
 template <typename T>
-void quick_delete(T &v, size_t idx) {
-    if (idx < v.size()) {
-        v[idx] = std::move(v.back());
-        v.pop_back();
+auto quick_delete(T &v, size_t idx) -> size_t {
+    if (idx >= v.size()) { return 0; }
+    const bool move{idx + 1 < v.size()};
+    if (move) { v[idx] = std::move(v.back()); }
+    v.pop_back();
+    return move ? 1 : 0;
+}
+
+template <typename T>
+auto quick_delete(T &v, typename T::iterator it) -> size_t {
+    return it < v.end() ? quick_delete(v, static_cast<size_t>(it - v.begin())) : 0;
+}
+
+// 批量删除，idx 必须严格递增；从前往后填洞，每个洞用尾部第一个不需要删除的元素填补
+// 不保持顺序，返回移动次数
+template <typename T>
+auto quick_delete(T &v, std::span<const size_t> idx) -> size_t {
+    size_t moves{};
+    size_t end{v.size()};
+    size_t lo{};
+    size_t hi{idx.size()};
+    while (lo < hi) {
+        while (hi > lo && idx[hi - 1] + 1 == end) { // 尾部元素本身也要删除
+            --hi;
+            --end;
+        }
+        if (lo == hi || idx[lo] >= end) { break; }
+        v[idx[lo++]] = std::move(v[--end]);
+        ++moves;
+    }
+    v.erase(v.begin() + static_cast<std::ptrdiff_t>(end), v.end());
+    return moves;
+}
+
+// 删除所有满足 pred 的元素，不保持顺序，返回移动次数
+template <typename T, typename Pred>
+auto quick_delete_if(T &v, Pred pred) -> size_t {
+    size_t moves{};
+    size_t i{};
+    size_t end{v.size()};
+    while (true) {
+        while (i < end && !pred(v[i])) { ++i; }
+        while (end > i && pred(v[end - 1])) { --end; }
+        if (i >= end) { break; }
+        v[i++] = std::move(v[--end]);
+        ++moves;
     }
+    v.erase(v.begin() + static_cast<std::ptrdiff_t>(end), v.end());
+    return moves;
 }
 
+// 保持顺序的批量删除，idx 必须严格递增，返回移动次数
 template <typename T>
-void quick_delete(T &v, typename T::iterator it) {
-    if (it < v.end()) {
-        *it = std::move(v.back());
-        v.pop_back();
+auto stable_delete(T &v, std::span<const size_t> idx) -> size_t {
+    if (idx.empty()) { return 0; }
+    size_t moves{};
+    size_t w{idx[0]};
+    for (size_t r{idx[0]}, k{}; r < v.size(); ++r) {
+        if (k < idx.size() && idx[k] == r) {
+            ++k;
+            continue;
+        }
+        v[w++] = std::move(v[r]);
+        ++moves;
+    }
+    v.erase(v.begin() + static_cast<std::ptrdiff_t>(w), v.end());
+    return moves;
+}
+
+// 与 std::erase_if 效果相同，返回移动次数
+template <typename T, typename Pred>
+auto stable_delete_if(T &v, Pred pred) -> size_t {
+    size_t moves{};
+    size_t w{};
+    for (size_t r{}; r < v.size(); ++r) {
+        if (pred(v[r])) { continue; }
+        if (w != r) {
+            v[w] = std::move(v[r]);
+            ++moves;
+        }
+        ++w;
     }
+    v.erase(v.begin() + static_cast<std::ptrdiff_t>(w), v.end());
+    return moves;
 }
 
-auto main() -> int {
+// 移动代价较高的对象，统计移动赋值次数
+struct Entity {
+    static inline size_t moves{};
+    int id{};
+    bool dead{};
+    string name{};
+    std::vector<double> payload{};
+
+    Entity(int i) : id{i}, name{format("entity-{:08}", i)}, payload(16, i) {}
+    Entity(Entity &&) noexcept = default;
+    Entity(const Entity &) = default;
+    auto operator=(const Entity &) -> Entity & = default;
+    auto operator=(Entity &&e) noexcept -> Entity & {
+        id = e.id;
+        dead = e.dead;
+        name = std::move(e.name);
+        payload = std::move(e.payload);
+        ++moves;
+        return *this;
+    }
+};
+
+// n 个实体中随机删除 10%，对比各种删除方式的耗时和移动次数
+void bench(ez::bench::Runner &runner) {
+    const size_t n{runner.count(0, 1'000'000)};
+    std::vector<Entity> base{};
+    base.reserve(n);
+    for (size_t i{}; i < n; ++i) { base.emplace_back(static_cast<int>(i)); }
+
+    std::mt19937 rng{42};
+    std::vector<size_t> idx(n);
+    for (size_t i{}; i < n; ++i) { idx[i] = i; }
+    std::ranges::shuffle(idx, rng);
+    idx.resize(n / 10);
+    std::ranges::sort(idx);
+    for (const size_t i : idx) { base[i].dead = true; }
+
+    auto run = [&](std::string_view name, auto &&del) {
+        runner.run(format("3.4/{}", name), idx.size(), [&] { return base; }, del);
+        auto v{base};
+        Entity::moves = 0;
+        const size_t reported{del(v)};
+        std::cerr << format("{:<22} {:9} moves (reported {}), {} left\n", name, Entity::moves, reported, v.size());
+    };
+
+    std::cerr << format("delete {} of {} entities\n", idx.size(), n);
+    run("repeated quick_delete", [&](auto &v) {
+        size_t moves{};
+        for (auto it{idx.rbegin()}; it != idx.rend(); ++it) { moves += quick_delete(v, *it); }
+        return moves;
+    });
+    run("quick_delete(indices)", [&](auto &v) { return quick_delete(v, idx); });
+    run("quick_delete_if", [&](auto &v) { return quick_delete_if(v, [](const Entity &e) { return e.dead; }); });
+    run("std::erase_if", [&](auto &v) { return std::erase_if(v, [](const Entity &e) { return e.dead; }); });
+    run("stable_delete(indices)", [&](auto &v) { return stable_delete(v, idx); });
+    run("stable_delete_if", [&](auto &v) { return stable_delete_if(v, [](const Entity &e) { return e.dead; }); });
+}
+
+auto main(int argc, char *argv[]) -> int {
+    if (ez::bench::requested(argc, argv)) {
+        ez::bench::Runner runner{argc, argv};
+        bench(runner);
+        return 0;
+    }
+
     std::vector v{12, 196, 47, 38, 19};
     printc(v);
     auto it = std::ranges::find(v, 47);
@@ -49,4 +195,15 @@ auto main() -> int {
     printc(v);
     quick_delete(v, 1);
     printc(v);
+
+    std::vector w{0, 1, 2, 3, 4, 5, 6, 7, 8, 9};
+    const std::vector<size_t> idx{1, 4, 8, 9};
+    auto moves{quick_delete(w, idx)};
+    cout << format("{} moves: ", moves);
+    printc(w);
+
+    w = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9};
+    moves = stable_delete_if(w, [](int x) { return x % 3 == 0; });
+    cout << format("{} moves: ", moves);
+    printc(w);
 }
@@ -11,11 +11,35 @@
 #include <string>
 #include <vector>
 
+#include "ez/bench.h"
+
 using std::cout;
 using std::format;
 using std::string;
 
-auto main() -> int {
+// 对比不检查边界的 operator[] 与检查边界的 at()
+void bench(ez::bench::Runner &runner) {
+    const size_t n{runner.count(0, 10'000'000)};
+    std::vector<int> v(n, 1);
+    runner.run("3.5/operator[]", n, [&] {
+        long long sum{};
+        for (size_t i{}; i < v.size(); ++i) { sum += v[i]; }
+        return sum;
+    });
+    runner.run("3.5/at()", n, [&] {
+        long long sum{};
+        for (size_t i{}; i < v.size(); ++i) { sum += v.at(i); }
+        return sum;
+    });
+}
+
+auto main(int argc, char *argv[]) -> int {
+    if (ez::bench::requested(argc, argv)) {
+        ez::bench::Runner runner{argc, argv};
+        bench(runner);
+        return 0;
+    }
+
     std::vector v{19, 71, 47, 192, 4004};
 
     auto &a = v[2]; // 不执行边界检查
@@ -7,11 +7,24 @@
  */
 
 #include <algorithm>
+#include <bit>
+#include <cstddef>
 #include <format>
+#include <functional>
+#include <initializer_list>
 #include <iostream>
+#include <map>
+#include <random>
+#include <ranges>
+#include <set>
 #include <string>
+#include <string_view>
+#include <utility>
 #include <vector>
 
+#include "ez/bench.h"
+#include "ez/sort.h"
+
 using std::cout;
 using std::format;
 using std::string;
@@ -41,7 +54,260 @@ void insert_sorted(C &c, const E &e) {
     c.insert(pos, e);
 }
 
-auto main() -> int {
+namespace ez {
+    // 无分支的 lower_bound：循环次数只取决于长度，比较结果只用于选择指针
+    template <typename T, typename K, typename Compare, typename Proj = std::identity>
+    auto branchless_lower_bound(const T *first, size_t len, const K &key, Compare comp, Proj proj = {}) -> const T * {
+        if (len == 0) { return first; }
+        const T *base{first};
+        while (len > 1) {
+            const size_t half{len / 2};
+            base = std::invoke(comp, std::invoke(proj, base[half]), key) ? base + half : base;
+            len -= half;
+        }
+        return base + static_cast<ptrdiff_t>(std::invoke(comp, std::invoke(proj, *base), key));
+    }
+
+    // 基于有序 vector 的集合，元素连续存放，适合读多写少的场景
+    template <typename T, typename Compare = std::less<>>
+    class flat_set {
+        std::vector<T> data_{};
+        [[no_unique_address]] Compare comp_{};
+
+        auto equal(const T &a, const auto &b) const -> bool { return !comp_(a, b) && !comp_(b, a); }
+
+      public:
+        using value_type = T;
+        using const_iterator = typename std::vector<T>::const_iterator;
+
+        flat_set() = default;
+        flat_set(std::initializer_list<T> init) { insert_range(init); }
+
+        [[nodiscard]] auto begin() const -> const_iterator { return data_.begin(); }
+        [[nodiscard]] auto end() const -> const_iterator { return data_.end(); }
+        [[nodiscard]] auto size() const -> size_t { return data_.size(); }
+        [[nodiscard]] auto empty() const -> bool { return data_.empty(); }
+        [[nodiscard]] auto data() const -> const T * { return data_.data(); }
+
+        [[nodiscard]] auto lower_bound(const auto &key) const -> const_iterator {
+            return begin() + (branchless_lower_bound(data_.data(), data_.size(), key, comp_) - data_.data());
+        }
+
+        [[nodiscard]] auto find(const auto &key) const -> const_iterator {
+            const auto it{lower_bound(key)};
+            return it != end() && equal(*it, key) ? it : end();
+        }
+
+        [[nodiscard]] auto contains(const auto &key) const -> bool { return find(key) != end(); }
+
+        // 单个插入，与 insert_sorted 相同，每次 O(n)
+        auto insert(T v) -> std::pair<const_iterator, bool> {
+            const auto it{lower_bound(v)};
+            if (it != end() && equal(*it, v)) { return {it, false}; }
+            return {data_.insert(it, std::move(v)), true};
+        }
+
+        // 批量插入：追加到末尾、排序新元素、与原有部分归并，再去重，共 O(n log n)
+        template <std::ranges::input_range R>
+        void insert_range(R &&r) {
+            const auto old{static_cast<ptrdiff_t>(data_.size())};
+            if constexpr (std::ranges::sized_range<R>) {
+                data_.reserve(data_.size() + std::ranges::size(r));
+            }
+            for (auto &&e : r) { data_.emplace_back(std::forward<decltype(e)>(e)); }
+            const auto mid{data_.begin() + old};
+            std::stable_sort(mid, data_.end(), comp_);
+            std::inplace_merge(data_.begin(), mid, data_.end(), comp_);
+            const auto dup{std::unique(data_.begin(), data_.end(), [this](const T &a, const T &b) { return equal(a, b); })};
+            data_.erase(dup, data_.end());
+        }
+
+        auto erase(const auto &key) -> size_t {
+            const auto it{find(key)};
+            if (it == end()) { return 0; }
+            data_.erase(it);
+            return 1;
+        }
+    };
+
+    // 基于有序 vector<pair<K, V>> 的映射
+    template <typename K, typename V, typename Compare = std::less<>>
+    class flat_map {
+        std::vector<std::pair<K, V>> data_{};
+        [[no_unique_address]] Compare comp_{};
+
+        static constexpr auto key_of = [](const std::pair<K, V> &p) -> const K & { return p.first; };
+
+        auto equal(const K &a, const auto &b) const -> bool { return !comp_(a, b) && !comp_(b, a); }
+
+        auto lower_index(const auto &key) const -> size_t {
+            return static_cast<size_t>(branchless_lower_bound(data_.data(), data_.size(), key, comp_, key_of) - data_.data());
+        }
+
+      public:
+        using value_type = std::pair<K, V>;
+        using const_iterator = typename std::vector<value_type>::const_iterator;
+
+        flat_map() = default;
+        flat_map(std::initializer_list<value_type> init) { insert_range(init); }
+
+        [[nodiscard]] auto begin() const -> const_iterator { return data_.begin(); }
+        [[nodiscard]] auto end() const -> const_iterator { return data_.end(); }
+        [[nodiscard]] auto size() const -> size_t { return data_.size(); }
+        [[nodiscard]] auto empty() const -> bool { return data_.empty(); }
+
+        [[nodiscard]] auto find(const auto &key) const -> const_iterator {
+            const size_t i{lower_index(key)};
+            return i < data_.size() && equal(data_[i].first, key) ? begin() + static_cast<ptrdiff_t>(i) : end();
+        }
+
+        [[nodiscard]] auto contains(const auto &key) const -> bool { return find(key) != end(); }
+
+        auto operator[](const K &key) -> V & {
+            const size_t i{lower_index(key)};
+            if (i == data_.size() || !equal(data_[i].first, key)) {
+                data_.emplace(data_.begin() + static_cast<ptrdiff_t>(i), key, V{});
+            }
+            return data_[i].second;
+        }
+
+        // 键重复时保留先出现的值，与 std::map::insert 一致
+        template <std::ranges::input_range R>
+        void insert_range(R &&r) {
+            const auto old{static_cast<ptrdiff_t>(data_.size())};
+            for (auto &&e : r) { data_.emplace_back(std::forward<decltype(e)>(e)); }
+            auto by_key = [this](const value_type &a, const value_type &b) { return comp_(a.first, b.first); };
+            const auto mid{data_.begin() + old};
+            std::stable_sort(mid, data_.end(), by_key);
+            std::inplace_merge(data_.begin(), mid, data_.end(), by_key);
+            const auto dup{std::unique(data_.begin(), data_.end(), [this](const value_type &a, const value_type &b) { return equal(a.first, b.first); })};
+            data_.erase(dup, data_.end());
+        }
+    };
+
+    // 只读的 Eytzinger（BFS 顺序）布局，查找路径上的元素在内存中相邻，便于预取
+    template <typename T, typename Compare = std::less<>>
+    class eytzinger_index {
+        std::vector<T> tree_{}; // 下标从 1 开始
+        [[no_unique_address]] Compare comp_{};
+
+        template <typename It>
+        auto build(It &it, size_t k) -> void {
+            if (k >= tree_.size()) { return; }
+            build(it, 2 * k);
+            tree_[k] = *it++;
+            build(it, 2 * k + 1);
+        }
+
+      public:
+        explicit eytzinger_index(const flat_set<T, Compare> &s) : tree_(s.size() + 1) {
+            auto it{s.begin()};
+            build(it, 1);
+        }
+
+        // 返回不小于 key 的第一个元素，没有时返回 nullptr
+        [[nodiscard]] auto lower_bound(const auto &key) const -> const T * {
+            size_t k{1};
+            while (k < tree_.size()) {
+                k = 2 * k + static_cast<size_t>(comp_(tree_[k], key));
+            }
+            k >>= std::countr_one(k) + 1;
+            return k == 0 ? nullptr : &tree_[k];
+        }
+
+        [[nodiscard]] auto contains(const auto &key) const -> bool {
+            const T *p{lower_bound(key)};
+            return p != nullptr && !comp_(key, *p);
+        }
+    };
+} // namespace ez
+
+// 对比逐个 insert_sorted 与 insert_range 的批量构建，以及各容器的查找速度
+void bench(ez::bench::Runner &runner) {
+    const size_t n{runner.count(0, 1'000'000)};
+    std::mt19937 rng{42};
+    std::uniform_int_distribution<int> letter{'a', 'z'};
+    Vstr keys(n);
+    for (auto &k : keys) {
+        k.resize(8 + rng() % 8);
+        for (auto &c : k) { c = static_cast<char>(letter(rng)); }
+    }
+    Vstr probes{keys};
+    std::ranges::shuffle(probes, rng);
+
+    const size_t m{std::min<size_t>(n, 50'000)};
+    runner.run("3.6/insert_sorted", m, [&] {
+        Vstr v{};
+        for (size_t i{}; i < m; ++i) { insert_sorted(v, keys[i]); }
+        return v.size();
+    });
+    runner.run("3.6/flat_set::insert_range", m, [&] {
+        ez::flat_set<string> fs{};
+        fs.insert_range(keys | std::views::take(m));
+        return fs.size();
+    });
+
+    const std::set<string> set(keys.begin(), keys.end());
+    std::map<string, size_t> map{};
+    std::vector<std::pair<string, size_t>> pairs{};
+    for (size_t i{}; i < n; ++i) {
+        map.emplace(keys[i], i);
+        pairs.emplace_back(keys[i], i);
+    }
+    ez::flat_set<string> fset{};
+    fset.insert_range(keys);
+    ez::flat_map<string, size_t> fmap{};
+    fmap.insert_range(pairs);
+    const ez::eytzinger_index<string> eytz{fset};
+
+    auto run = [&](std::string_view name, auto &&contains) {
+        runner.run(format("3.6/lookup/{}", name), n, [&] {
+            size_t hits{};
+            for (const auto &p : probes) { hits += contains(p) ? 1 : 0; }
+            return hits;
+        });
+    };
+    run("std::set", [&](const string &k) { return set.contains(k); });
+    run("std::map", [&](const string &k) { return map.contains(k); });
+    run("flat_set", [&](const string &k) { return fset.contains(k); });
+    run("flat_map", [&](const string &k) { return fmap.contains(k); });
+    run("eytzinger", [&](const string &k) { return eytz.contains(k); });
+}
+
+// 10^7 个随机字符串：ranges::sort、并行归并排序和多键快速排序
+void bench_sort(ez::bench::Runner &runner) {
+    const size_t n{runner.count(1, 10'000'000)};
+    std::mt19937 rng{7};
+    Vstr data(n);
+    for (auto &s : data) {
+        s.resize(4 + rng() % 20);
+        for (auto &c : s) { c = static_cast<char>('a' + rng() % 26); }
+    }
+    Vstr expected{data};
+    std::ranges::sort(expected);
+
+    auto run = [&](std::string_view name, auto &&sort) {
+        Vstr v{};
+        runner.run(format("3.6/sort/{}", name), n, [&] { return data; }, [&](Vstr &s) {
+            sort(s);
+            v = std::move(s);
+            return v.size();
+        });
+        std::cerr << format("{:<16} {}\n", name, v == expected ? "sorted" : "WRONG");
+    };
+    run("ranges::sort", [](Vstr &v) { std::ranges::sort(v); });
+    run("ez::par_sort", [](Vstr &v) { ez::par_sort(v); });
+    run("ez::string_sort", [](Vstr &v) { ez::string_sort(v); });
+}
+
+auto main(int argc, char *argv[]) -> int {
+    if (ez::bench::requested(argc, argv)) {
+        ez::bench::Runner runner{argc, argv, {.warmup = 1, .runs = 5}};
+        bench(runner);
+        bench_sort(runner);
+        return 0;
+    }
+
     Vstr v{"Miles",
            "Hendrix",
            "Beatles",
@@ -53,7 +319,16 @@ auto main() -> int {
     std::ranges::sort(v);
     psorted(v);
 
+    Vstr w{"Miles", "Hendrix", "Beatles", "Zappa", "Shostakovich"};
+    ez::string_sort(w); // 按字节比较，顺序与 ranges::sort 相同
+    psorted(w);
+
     insert_sorted(v, "Ella");
     insert_sorted(v, "Stones");
     psorted(v);
+
+    ez::flat_set<string> fs{"Miles", "Hendrix", "Beatles", "Zappa", "Shostakovich"};
+    fs.insert_range(Vstr{"Ella", "Stones", "Miles"});
+    printv(fs);
+    cout << format("contains Zappa: {}\n", fs.contains("Zappa"));
 }
@@ -6,12 +6,23 @@
  * @Description  : 高效地将元素插入到 map 中
  */
 
+#include <algorithm>
 #include <format>
+#include <functional>
 #include <iostream>
+#include <ranges>
 #include <string>
+#include <string_view>
+#include <tuple>
 
 #include <map>
+#include <unordered_map>
 #include <utility>
+#include <vector>
+
+#include "ez/alloc_counter.h"
+#include "ez/bench.h"
+#include "ez/string_map.h"
 
 using std::cin;
 using std::cout;
@@ -19,15 +30,111 @@ using std::endl;
 using std::format;
 using std::string;
 
+// 统计构造、复制和赋值的次数，用来验证批量插入没有多余的构造
 struct BigThing {
     string v_;
 
+    static inline size_t constructed{};
+    static inline size_t copied{};
+    static inline size_t assigned{};
+    static inline bool verbose{true};
+
     BigThing(const char *v) : v_(v) {
-        cout << format("BigThing constructed {}\n", v_);
+        ++constructed;
+        if (verbose) { cout << format("BigThing constructed {}\n", v_); }
+    }
+    BigThing(const BigThing &o) : v_(o.v_) { ++copied; }
+    auto operator=(const BigThing &o) -> BigThing & {
+        v_ = o.v_;
+        ++copied;
+        return *this;
     }
+    auto operator=(const char *v) -> BigThing & {
+        v_ = v;
+        ++assigned;
+        return *this;
+    }
+
+    static void reset() { constructed = copied = assigned = 0; }
+    static auto counts() -> string { return format("{} constructed, {} copied, {} assigned", constructed, copied, assigned); }
 };
 
-using Mymap = std::map<string, BigThing>;
+using Mymap = ez::string_map<BigThing>; // std::less<> 可以直接用 string_view 查找
+
+// 批量插入：batch 的元素为 (键, 构造值的参数) 对，键需要能用 map 的比较器比较
+// 先按键稳定排序（已经有序时跳过），再沿 map 单趟归并：相邻的键沿迭代器前进，较远时二分查找，
+// 找到的位置作为插入提示，每个键只查找一次
+namespace ez {
+    namespace detail {
+        template <typename M, typename K>
+        auto seek(M &m, typename M::iterator it, const K &k) -> typename M::iterator {
+            const auto comp{m.key_comp()};
+            for (int step{}; step < 8; ++step, ++it) {
+                if (it == m.end() || !comp(it->first, k)) { return it; }
+            }
+            return m.lower_bound(k);
+        }
+
+        // 对每组相同的键调用 f(pos, first, last)：pos 为 m 中第一个不小于该键的位置，first / last 为该键在批量中
+        // 第一次和最后一次出现；f 返回 map 中该键所在的位置
+        template <typename M, typename R, typename F>
+        void merge_walk(M &m, R &batch, F &&f) {
+            std::vector<std::ranges::iterator_t<R>> items{};
+            for (auto it{std::ranges::begin(batch)}; it != std::ranges::end(batch); ++it) { items.push_back(it); }
+            const auto comp{m.key_comp()};
+            auto less = [&](const auto &a, const auto &b) { return comp(std::get<0>(*a), std::get<0>(*b)); };
+            if (!std::ranges::is_sorted(items, less)) { std::ranges::stable_sort(items, less); }
+
+            auto pos{m.begin()};
+            for (size_t i{}; i < items.size();) {
+                size_t j{i + 1};
+                while (j < items.size() && !less(items[i], items[j])) { ++j; }
+                pos = seek(m, pos, std::get<0>(*items[i]));
+                pos = std::next(f(pos, items[i], items[j - 1]));
+                i = j;
+            }
+        }
+    } // namespace detail
+
+    // 与逐个 try_emplace 结果相同：已有的键不构造值，批量中重复的键以第一次出现为准；返回新插入的个数
+    template <typename M, std::ranges::forward_range R>
+    auto try_emplace_range(M &m, R &&batch) -> size_t {
+        size_t inserted{};
+        detail::merge_walk(m, batch, [&](auto pos, auto first, auto) {
+            const auto &[k, v]{*first};
+            if (pos != m.end() && !m.key_comp()(k, pos->first)) { return pos; }
+            ++inserted;
+            return m.emplace_hint(pos, std::piecewise_construct, std::forward_as_tuple(k), std::forward_as_tuple(v));
+        });
+        return inserted;
+    }
+
+    // 与逐个 insert_or_assign 结果相同：已有的键直接赋值，批量中重复的键只赋最后一次的值；返回新插入的个数
+    // spare 中的节点（例如之前 extract 出来淘汰的项）优先用于新键，改写键和值后插入，不再分配和构造
+    // spare 中的空节点（extract 不存在的键得到的结果）被丢弃
+    template <typename M, std::ranges::forward_range R>
+    auto insert_or_assign_range(M &m, R &&batch, std::vector<typename M::node_type> *spare = nullptr) -> size_t {
+        size_t inserted{};
+        detail::merge_walk(m, batch, [&](auto pos, auto, auto last) {
+            const auto &[k, v]{*last};
+            if (pos != m.end() && !m.key_comp()(k, pos->first)) {
+                pos->second = v;
+                return pos;
+            }
+            ++inserted;
+            while (spare != nullptr && !spare->empty() && spare->back().empty()) { spare->pop_back(); }
+            if (spare != nullptr && !spare->empty()) {
+                auto node{std::move(spare->back())};
+                spare->pop_back();
+                node.key() = k;
+                node.mapped() = v;
+                return m.insert(pos, std::move(node));
+            }
+            return m.emplace_hint(pos, std::piecewise_construct, std::forward_as_tuple(k), std::forward_as_tuple(v));
+        });
+        return inserted;
+    }
+} // namespace ez
 
 void print(const auto &m) {
     for (const auto &[k, v] : m) {
@@ -36,7 +143,115 @@ void print(const auto &m) {
     cout << "\n";
 }
 
-auto main() -> int {
+// 大部分键重复时，emplace 仍然构造值对象，try_emplace 则不会
+void bench(ez::bench::Runner &runner) {
+    const size_t n{runner.count(0, 1'000'000)};
+    std::vector<string> keys(n);
+    for (size_t i{}; i < n; ++i) { keys[i] = format("key-{}", i % (n / 10 + 1)); }
+    const string value(64, 'v');
+
+    runner.run("3.7/emplace", n, [&] {
+        std::map<string, string> m;
+        for (const auto &k : keys) { m.emplace(k, value); }
+        return m.size();
+    });
+    runner.run("3.7/try_emplace", n, [&] {
+        std::map<string, string> m;
+        for (const auto &k : keys) { m.try_emplace(k, value); }
+        return m.size();
+    });
+}
+
+// 以 string_view 查找：普通的 map 必须先构造 std::string，透明比较器和哈希可以直接查找
+// 键较长（超过 SSO 长度）时，每次构造临时字符串都是一次堆分配
+template <typename M>
+void bench_lookup(ez::bench::Runner &runner, std::string_view name, const std::vector<string> &keys,
+                  const std::vector<std::string_view> &queries) {
+    M m{};
+    for (const auto &k : keys) { m.try_emplace(k, k.size()); }
+    auto lookup_all = [&] {
+        size_t hits{};
+        for (const auto q : queries) {
+            if constexpr (requires { m.find(q); }) {
+                hits += m.find(q) != m.end() ? 1 : 0;
+            } else {
+                hits += m.find(string{q}) != m.end() ? 1 : 0;
+            }
+        }
+        return hits;
+    };
+    runner.run(name, queries.size(), lookup_all);
+
+    const ez::alloc::Scope scope{};
+    lookup_all();
+    std::cerr << format("{:<36} {:.2f} allocations/lookup\n", name,
+                   static_cast<double>(scope.allocations()) / static_cast<double>(queries.size()));
+}
+
+void bench_lookups(ez::bench::Runner &runner) {
+    const size_t n{runner.count(1, 100'000)};
+    std::vector<string> keys(n);
+    for (size_t i{}; i < n; ++i) { keys[i] = format("recipe/03.07/key-{:08}", i); }
+    std::vector<string> text{}; // 查询的字符串来自另一块缓冲区，与键不共享存储
+    for (size_t i{}; i < n; ++i) { text.push_back(keys[(i * 7919) % n]); }
+    const std::vector<std::string_view> queries(text.begin(), text.end());
+
+    bench_lookup<std::map<string, size_t>>(runner, "3.7/lookup/map<string>", keys, queries);
+    bench_lookup<ez::string_map<size_t>>(runner, "3.7/lookup/map<string, less<>>", keys, queries);
+    bench_lookup<std::unordered_map<string, size_t>>(runner, "3.7/lookup/unordered_map<string>", keys, queries);
+    bench_lookup<ez::unordered_string_map<size_t>>(runner, "3.7/lookup/unordered_map transparent", keys, queries);
+}
+
+// n 个键的 map 上插入 n 项的批量，约 90% 的键已经存在
+void bench_batch(ez::bench::Runner &runner) {
+    const size_t n{runner.count(2, 100'000)};
+    const string value(64, 'v');
+    Mymap base{};
+    BigThing::verbose = false;
+    for (size_t i{}; i < n; ++i) { base.try_emplace(format("key-{:08}", i * 2), value.c_str()); }
+    std::vector<std::pair<string, const char *>> batch(n);
+    for (size_t i{}; i < n; ++i) {
+        const size_t k{(i * 7919) % n};
+        batch[i] = {format("key-{:08}", i % 10 == 0 ? k * 2 + 1 : k * 2), value.c_str()};
+    }
+    auto sorted{batch};
+    std::ranges::stable_sort(sorted, {}, &std::pair<string, const char *>::first);
+
+    auto report = [&](std::string_view name, auto &&f) {
+        runner.run(name, n, [&] { return base; }, f);
+        Mymap m{base};
+        BigThing::reset();
+        f(m);
+        std::cerr << format("{:<36} {}\n", name, BigThing::counts());
+    };
+    report("3.7/batch/emplace loop", [&](Mymap &m) {
+        for (const auto &[k, v] : batch) { m.emplace(k, v); }
+        return m.size();
+    });
+    report("3.7/batch/try_emplace loop", [&](Mymap &m) {
+        for (const auto &[k, v] : batch) { m.try_emplace(k, v); }
+        return m.size();
+    });
+    report("3.7/batch/try_emplace_range", [&](Mymap &m) { return ez::try_emplace_range(m, batch); });
+    report("3.7/batch/try_emplace_range sorted", [&](Mymap &m) { return ez::try_emplace_range(m, sorted); });
+    report("3.7/batch/insert_or_assign loop", [&](Mymap &m) {
+        for (const auto &[k, v] : batch) { m.insert_or_assign(k, v); }
+        return m.size();
+    });
+    report("3.7/batch/insert_or_assign_range", [&](Mymap &m) { return ez::insert_or_assign_range(m, batch); });
+    BigThing::verbose = true;
+}
+
+auto main(int argc, char *argv[]) -> int {
+    if (ez::bench::requested(argc, argv)) {
+        ez::bench::Runner runner{argc, argv, {.warmup = 1, .runs = 5}};
+        bench(runner);
+        bench_lookups(runner);
+        bench_batch(runner);
+        return 0;
+    }
+
+
     {
         std::map<string, string> m;
 
@@ -56,4 +271,30 @@ auto main() -> int {
     m.try_emplace("Zappa", "Guitar");  // 调用构造函数
     m.try_emplace("Miles", "Trumpet"); // 重复键值没有构造对象
     print(m);
+
+    // 透明比较器：用 string_view 和 const char* 查找都不构造 std::string
+    const std::string_view who{"Zappa"};
+    const ez::alloc::Scope scope{};
+    const bool found{m.contains(who) && m.find("Krupa") != m.end()};
+    cout << format("found: {}, {} allocations\n", found, scope.allocations());
+
+    // 批量插入：只为新键构造，重复的 Miles 和 Zappa 不构造
+    BigThing::reset();
+    const std::vector<std::pair<std::string_view, const char *>> batch{
+        {"Zappa", "Guitar"}, {"Coltrane", "Sax"}, {"Miles", "Trumpet"}, {"Bonham", "Drums"}, {"Coltrane", "Sax"}};
+    const size_t added{ez::try_emplace_range(m, batch)};
+    cout << format("try_emplace_range: {} new, {}\n", added, BigThing::counts());
+    print(m);
+
+    // 淘汰两项，节点留给下一批新键使用
+    std::vector<Mymap::node_type> spare{};
+    spare.push_back(m.extract("Krupa"));
+    spare.push_back(m.extract("Hendrix"));
+    spare.push_back(m.extract("Nobody")); // 不存在的键得到空节点，会被跳过
+    BigThing::reset();
+    const std::vector<std::pair<std::string_view, const char *>> update{
+        {"Miles", "Flugelhorn"}, {"Peart", "Drums"}, {"Page", "Guitar"}};
+    const size_t replaced{ez::insert_or_assign_range(m, update, &spare)};
+    cout << format("insert_or_assign_range: {} new, {}\n", replaced, BigThing::counts());
+    print(m);
 }
@@ -6,23 +6,41 @@
  * @Description  : 高效地修改 map 项的键值
  */
 
+#include <algorithm>
 #include <format>
+#include <functional>
 #include <iostream>
 #include <map>
+#include <memory_resource>
+#include <numeric>
+#include <span>
 #include <string>
+#include <utility>
+#include <vector>
+
+#include "ez/alloc_counter.h"
+#include "ez/bench.h"
+#include "ez/outbuf.h"
 
 using Racermap = std::map<unsigned int, std::string>;
 
+// 节点和字符串都从 memory_resource 分配，搭配池或单调缓冲区时节点的增删不经过 malloc
+namespace pmr {
+    using Racermap = std::pmr::map<unsigned int, std::pmr::string>;
+}
+
 using std::cin, std::cout, std::endl;
 using std::format;
 using std::string;
 
 void printm(const auto &m) {
-    cout << "Rank:\n";
+    auto &out{ez::out()};
+    out.write("Rank:\n");
     for (const auto &[rank, racer] : m) {
-        cout << format("{}:{}\n", rank, racer);
+        out.put<"{}:{}\n">(rank, racer);
     }
-    cout << "\n";
+    out.write("\n");
+    out.flush();
 }
 
 template <typename M, typename K>
@@ -36,10 +54,137 @@ auto node_swap(M &m, K k1, K k2) -> bool {
     return true;
 }
 
-auto main() -> int {
+// 批量修改键：moves 中每一项为 (旧键, 新键)，旧键集合与新键集合必须相同，即对这些键做一次置换
+// 每个节点只 extract 一次、insert 一次，不分配也不复制值
+// 按旧键顺序摘取，相邻的键直接沿迭代器前进；按新键从大到小插入，以上一次插入的位置作为提示，
+// 受影响的键在 map 中连续时（例如整个排行榜或一段名次）每个节点摊还 O(1)
+// 旧键不存在、重复或不构成置换时返回 false，map 不变
+template <typename M>
+auto reorder(M &m, std::span<const std::pair<typename M::key_type, typename M::key_type>> moves) -> bool {
+    using K = typename M::key_type;
+    const auto &comp{m.key_comp()};
+    std::vector<std::pair<K, K>> sorted(moves.begin(), moves.end());
+    std::ranges::sort(sorted, comp, &std::pair<K, K>::first);
+
+    std::vector<K> to{};
+    to.reserve(sorted.size());
+    for (const auto &mv : sorted) { to.push_back(mv.second); }
+    std::ranges::sort(to, comp);
+    const auto same = [&](const K &a, const K &b) { return !comp(a, b) && !comp(b, a); };
+    // 同一个旧键出现两次时两边的多重集合仍可能相同，但同一个节点不能摘取两次
+    if (std::ranges::adjacent_find(sorted, same, &std::pair<K, K>::first) != sorted.end()) { return false; }
+    if (!std::ranges::equal(sorted, to, same, &std::pair<K, K>::first)) { return false; } // 新键不是旧键的置换
+
+    // 先确认所有旧键都存在，之后的摘取不会失败
+    std::vector<typename M::iterator> pos{};
+    pos.reserve(sorted.size());
+    for (auto it{m.begin()}; const auto &mv : sorted) {
+        if (it == m.end() || !same(it->first, mv.first)) { it = m.find(mv.first); }
+        if (it == m.end()) { return false; }
+        pos.push_back(it++);
+    }
+
+    std::vector<typename M::node_type> nodes{};
+    nodes.reserve(sorted.size());
+    for (size_t i{}; i < pos.size(); ++i) {
+        nodes.push_back(m.extract(pos[i])); // 只使其自身失效，其余迭代器仍然有效
+        nodes.back().key() = sorted[i].second;
+    }
+    std::ranges::sort(nodes, [&](const auto &a, const auto &b) { return comp(b.key(), a.key()); });
+    for (auto hint{m.end()}; auto &node : nodes) { hint = m.insert(hint, std::move(node)); }
+    return true;
+}
+
+// 反复建立并清空 n 个节点的 map：默认分配器、同步池与单调缓冲区
+void bench_alloc(ez::bench::Runner &runner, size_t n) {
+    auto fill = [n](auto &m) {
+        for (unsigned i{1}; i <= n; ++i) { m.emplace(i, "racer"); }
+        return m.size();
+    };
+    auto report = [&](std::string_view name, auto &&f) {
+        runner.run(name, n, f);
+        const ez::alloc::Scope scope{};
+        f();
+        std::cerr << format("{:<36} {} allocations\n", name, scope.allocations());
+    };
+
+    report("3.8/build/std::allocator", [&] {
+        Racermap m{};
+        return fill(m);
+    });
+    std::pmr::unsynchronized_pool_resource pool{};
+    report("3.8/build/pmr pool", [&] {
+        pmr::Racermap m{&pool}; // 池在多次运行之间复用，释放的节点回到池中
+        return fill(m);
+    });
+    std::vector<std::byte> arena(n * 128);
+    report("3.8/build/pmr monotonic", [&] {
+        std::pmr::monotonic_buffer_resource mono{arena.data(), arena.size()};
+        pmr::Racermap m{&mono};
+        return fill(m);
+    });
+}
+
+// 随机交换 n 个名次
+void bench(ez::bench::Runner &runner) {
+    const size_t n{std::max<size_t>(2, runner.count(0, 100'000))}; // node_swap 需要两个不同的键
+    Racermap racers{};
+    for (unsigned i{1}; i <= n; ++i) { racers.emplace(i, format("racer-{}", i)); }
+    std::vector<std::pair<unsigned, unsigned>> swaps(n);
+    for (unsigned i{}; auto &[a, b] : swaps) {
+        a = i % n + 1;
+        b = (i * 7919U) % n + 1;
+        if (a == b) { b = a % n + 1; } // node_swap 要求两个键不同
+        ++i;
+    }
+
+    runner.run("3.8/node_swap", n, [&] { return racers; }, [&](Racermap &m) {
+        size_t ok{};
+        for (const auto &[a, b] : swaps) { ok += node_swap(m, a, b) ? 1 : 0; }
+        return ok;
+    });
+
+    // 同样的交换序列合成一个置换，reorder 一次完成
+    std::vector<unsigned> at(n + 1); // at[r]：交换后排在 r 的原名次
+    std::iota(at.begin(), at.end(), 0U);
+    for (const auto &[a, b] : swaps) { std::swap(at[a], at[b]); }
+    std::vector<std::pair<unsigned, unsigned>> moves{};
+    for (unsigned r{1}; r <= n; ++r) { moves.emplace_back(at[r], r); }
+
+    runner.run("3.8/reorder", n, [&] { return racers; }, [&](Racermap &m) { return reorder<Racermap>(m, moves); });
+
+    Racermap by_swap{racers};
+    for (const auto &[a, b] : swaps) { node_swap(by_swap, a, b); }
+    Racermap by_reorder{racers};
+    const ez::alloc::Scope scope{};
+    reorder<Racermap>(by_reorder, moves);
+    std::cerr << format("reorder {}, {} allocations\n", by_swap == by_reorder ? "matches node_swap" : "DIFFERS",
+                   scope.allocations());
+
+    bench_alloc(runner, n);
+}
+
+auto main(int argc, char *argv[]) -> int {
+    if (ez::bench::requested(argc, argv)) {
+        ez::bench::Runner runner{argc, argv};
+        bench(runner);
+        return 0;
+    }
+
     Racermap racers{
         {1, "Mario"}, {2, "Luigi"}, {3, "Bowser"}, {4, "Peach"}, {5, "Donkey Kong Jr"}};
     printm(racers);
     node_swap(racers, 3, 5);
     printm(racers);
+
+    // 名次整体后移一位，第 5 名变为第 1 名
+    const std::vector<std::pair<unsigned, unsigned>> rotate{{1, 2}, {2, 3}, {3, 4}, {4, 5}, {5, 1}};
+    reorder<Racermap>(racers, rotate);
+    printm(racers);
+
+    // 旧键重复：新旧键的多重集合相同，但不是置换，拒绝且不修改 map
+    const std::vector<std::pair<unsigned, unsigned>> repeated{{1, 2}, {2, 1}, {1, 2}, {2, 1}};
+    const Racermap before{racers};
+    const bool ok{reorder<Racermap>(racers, repeated)};
+    cout << format("repeated keys: {}, map {}\n", ok ? "accepted" : "rejected", racers == before ? "unchanged" : "CHANGED");
 }
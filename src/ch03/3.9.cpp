@@ -1,8 +1,19 @@
+#include <bit>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
 #include <format>
 #include <iostream>
+#include <random>
+#include <stdexcept>
 #include <string>
+#include <string_view>
 #include <unordered_map>
-#include <vcruntime.h>
+#include <utility>
+#include <vector>
+
+#include "ez/bench.h"
+#include "ez/outbuf.h"
 
 using std::cin, std::cout, std::endl;
 using std::format;
@@ -20,22 +31,205 @@ auto operator==(const Coord &lhs, const Coord &rhs) -> bool {
 }
 
 namespace std {
+    // 将 x、y 拼成 64 位整数，再用 splitmix64 的终结函数打散所有位
     template <>
     struct hash<Coord> {
         auto operator()(const Coord &c) const -> size_t {
-            return static_cast<size_t>(c.x) + static_cast<size_t>(c.y);
+            uint64_t k{(static_cast<uint64_t>(static_cast<uint32_t>(c.x)) << 32) | static_cast<uint32_t>(c.y)};
+            k = (k ^ (k >> 30)) * 0xbf58476d1ce4e5b9ULL;
+            k = (k ^ (k >> 27)) * 0x94d049bb133111ebULL;
+            return static_cast<size_t>(k ^ (k >> 31));
         }
     };
 } // namespace std
 
+// 原来的哈希：同一条反对角线上的坐标全部冲突，仅用于对比
+struct CoordSumHash {
+    auto operator()(const Coord &c) const -> size_t {
+        return static_cast<size_t>(c.x) + static_cast<size_t>(c.y);
+    }
+};
+
+// 开放寻址（线性探测）的 Coord 表，键和值分别按列 (SoA) 存放
+class FlatCoordmap {
+    std::vector<int> xs_{};
+    std::vector<int> ys_{};
+    std::vector<int> values_{};
+    std::vector<uint8_t> used_{};
+    size_t size_{};
+
+    [[nodiscard]] auto mask() const -> size_t { return used_.size() - 1; }
+
+    [[nodiscard]] auto slot_of(const Coord &c) const -> size_t {
+        size_t i{std::hash<Coord>{}(c) & mask()};
+        while (used_[i] != 0 && (xs_[i] != c.x || ys_[i] != c.y)) {
+            i = (i + 1) & mask();
+        }
+        return i;
+    }
+
+    void rehash(size_t capacity) {
+        auto xs{std::exchange(xs_, std::vector<int>(capacity))};
+        auto ys{std::exchange(ys_, std::vector<int>(capacity))};
+        auto values{std::exchange(values_, std::vector<int>(capacity))};
+        auto used{std::exchange(used_, std::vector<uint8_t>(capacity))};
+        for (size_t i{}; i < used.size(); ++i) {
+            if (used[i] == 0) { continue; }
+            const size_t j{slot_of({xs[i], ys[i]})};
+            xs_[j] = xs[i];
+            ys_[j] = ys[i];
+            values_[j] = values[i];
+            used_[j] = 1;
+        }
+    }
+
+  public:
+    FlatCoordmap() { rehash(16); }
+
+    FlatCoordmap(std::initializer_list<std::pair<Coord, int>> init) : FlatCoordmap() {
+        for (const auto &[c, v] : init) { try_emplace(c, v); }
+    }
+
+    [[nodiscard]] auto size() const -> size_t { return size_; }
+
+    void reserve(size_t n) {
+        if (n * 2 > used_.size()) { rehash(std::bit_ceil(n * 2)); }
+    }
+
+    // 负载因子保持在 1/2 以下；键已存在时不修改
+    auto try_emplace(const Coord &c, int v) -> bool {
+        reserve(size_ + 1);
+        const size_t i{slot_of(c)};
+        if (used_[i] != 0) { return false; }
+        xs_[i] = c.x;
+        ys_[i] = c.y;
+        values_[i] = v;
+        used_[i] = 1;
+        ++size_;
+        return true;
+    }
+
+    [[nodiscard]] auto find(const Coord &c) const -> const int * {
+        const size_t i{slot_of(c)};
+        return used_[i] != 0 ? &values_[i] : nullptr;
+    }
+
+    [[nodiscard]] auto at(const Coord &c) const -> const int & {
+        if (const int *p{find(c)}; p != nullptr) { return *p; }
+        throw std::out_of_range("FlatCoordmap::at");
+    }
+
+    void for_each(auto &&f) const {
+        for (size_t i{}; i < used_.size(); ++i) {
+            if (used_[i] != 0) { f(Coord{xs_[i], ys_[i]}, values_[i]); }
+        }
+    }
+
+    // 每个键到其理想槽位的探测距离
+    [[nodiscard]] auto probe_lengths() const -> std::vector<size_t> {
+        std::vector<size_t> v{};
+        v.reserve(size_);
+        for_each([&](const Coord &c, int) {
+            const size_t home{std::hash<Coord>{}(c) & mask()};
+            v.push_back((slot_of(c) - home) & mask());
+        });
+        return v;
+    }
+};
+
 void print_Coordmap(const auto &m) {
+    auto &out{ez::out()};
     for (const auto &[key, value] : m) {
-        cout << format("{{ ({}, {}): {} }} ", key.x, key.y, value);
+        out.print("{{ ({}, {}): {} }} ", key.x, key.y, value);
+    }
+    out.write("\n");
+    out.flush();
+}
+
+void print_Coordmap(const FlatCoordmap &m) {
+    auto &out{ez::out()};
+    m.for_each([&out](const Coord &key, int value) {
+        out.print("{{ ({}, {}): {} }} ", key.x, key.y, value);
+    });
+    out.write("\n");
+    out.flush();
+}
+
+auto lookup(const auto &m, const Coord &k) -> const int * { return &m.find(k)->second; }
+auto lookup(const FlatCoordmap &m, const Coord &k) -> const int * { return m.find(k); }
+
+// 按 2 的幂分组的直方图：0, 1, 2-3, 4-7, ...
+void print_histogram(std::string_view title, const std::vector<size_t> &values) {
+    std::vector<size_t> bins{};
+    for (const size_t v : values) {
+        const size_t b{static_cast<size_t>(std::bit_width(v))};
+        if (b >= bins.size()) { bins.resize(b + 1); }
+        ++bins[b];
+    }
+    std::cerr << format("  {}\n", title);
+    for (size_t b{}; b < bins.size(); ++b) {
+        const size_t lo{b == 0 ? 0 : size_t{1} << (b - 1)};
+        const size_t hi{b == 0 ? 0 : (size_t{1} << b) - 1};
+        std::cerr << format("    {:>13}: {}\n", lo == hi ? format("{}", lo) : format("{}-{}", lo, hi), bins[b]);
+    }
+}
+
+// 插入和查找分别计时，再输出冲突直方图
+template <typename Map>
+void bench_map(ez::bench::Runner &runner, std::string_view name, const std::vector<Coord> &keys, auto &&histogram) {
+    auto fill = [&keys](Map &m) {
+        for (int i{}; const auto &k : keys) { m.try_emplace(k, i++); }
+        return m.size();
+    };
+    runner.run(format("{}/insert", name), keys.size(), [] { return Map{}; }, fill);
+
+    Map m{};
+    fill(m);
+    runner.run(format("{}/lookup", name), keys.size(), [&] {
+        long long sum{};
+        for (const auto &k : keys) { sum += *lookup(m, k); }
+        return sum;
+    });
+    histogram(name, m);
+}
+
+// 稠密网格和稀疏随机坐标各 n 个
+void bench(ez::bench::Runner &runner) {
+    const size_t n{runner.count(0, 1'000'000)};
+    std::vector<Coord> dense{};
+    const int side{static_cast<int>(std::sqrt(static_cast<double>(n)))};
+    for (int x{}; x < side; ++x) {
+        for (int y{}; y < side; ++y) { dense.push_back({x, y}); }
+    }
+
+    std::mt19937 rng{42};
+    std::uniform_int_distribution<int> dist{-1'000'000, 1'000'000};
+    std::vector<Coord> sparse(n);
+    for (auto &c : sparse) { c = {dist(rng), dist(rng)}; }
+
+    auto buckets = [](std::string_view name, const auto &m) {
+        std::vector<size_t> sizes(m.bucket_count());
+        for (size_t b{}; b < sizes.size(); ++b) { sizes[b] = m.bucket_size(b); }
+        print_histogram(format("{} bucket size histogram", name), sizes);
+    };
+    auto probes = [](std::string_view name, const FlatCoordmap &m) {
+        print_histogram(format("{} probe length histogram", name), m.probe_lengths());
+    };
+
+    for (const auto &[grid, keys] : {std::pair{"dense", &dense}, std::pair{"sparse", &sparse}}) {
+        bench_map<std::unordered_map<Coord, int, CoordSumHash>>(runner, format("3.9/{}/sum_hash", grid), *keys, buckets);
+        bench_map<Coordmap>(runner, format("3.9/{}/mixed_hash", grid), *keys, buckets);
+        bench_map<FlatCoordmap>(runner, format("3.9/{}/FlatCoordmap", grid), *keys, probes);
     }
-    cout << "\n";
 }
 
-auto main() -> int {
+auto main(int argc, char *argv[]) -> int {
+    if (ez::bench::requested(argc, argv)) {
+        ez::bench::Runner runner{argc, argv, {.warmup = 0, .runs = 3}};
+        bench(runner);
+        return 0;
+    }
+
     Coordmap m{
         {{0, 0}, 1},
         {{0, 1}, 2},
@@ -44,4 +238,12 @@ auto main() -> int {
     print_Coordmap(m);
     Coord k{0, 1};
     cout << format("{{ ({}, {}): {} }}\n", k.x, k.y, m.at(k));
+
+    FlatCoordmap fm{
+        {{0, 0}, 1},
+        {{0, 1}, 2},
+        {{2, 1}, 3},
+    };
+    print_Coordmap(fm);
+    cout << format("{{ ({}, {}): {} }}\n", k.x, k.y, fm.at(k));
 }
@@ -0,0 +1,165 @@
+/*
+ * @Author       : ExilsZ
+ * @LastEditor   : ExilsZ
+ * @Date         : 26-10-17 10:12
+ * @LastEditTime :
+ * @Description  : 列出目录中的文件
+ */
+
+#include <algorithm>
+#include <cstdint>
+#include <filesystem>
+#include <format>
+#include <iostream>
+#include <span>
+#include <string>
+#include <system_error>
+#include <vector>
+
+#include "ez/bench.h"
+#include "ez/sort.h"
+#include "ez/walk.h"
+
+namespace fs = std::filesystem;
+using de = fs::directory_entry;
+using rdit = fs::recursive_directory_iterator;
+
+using std::cout;
+using std::format;
+using std::string;
+using std::vector;
+
+auto strlower(string s) -> string {
+    std::ranges::transform(s, s.begin(), [](char c) { return c >= 'A' && c <= 'Z' ? static_cast<char>(c + ('a' - 'A')) : c; });
+    return s;
+}
+
+// 不区分大小写地按路径排序
+auto dircmp_lc(const de &lhs, const de &rhs) -> bool {
+    return strlower(lhs.path().string()) < strlower(rhs.path().string());
+}
+
+auto type_char(const fs::file_status &fstat) -> char {
+    if (is_symlink(fstat)) { return 'l'; }
+    if (is_directory(fstat)) { return 'd'; }
+    if (is_character_file(fstat)) { return 'c'; }
+    if (is_block_file(fstat)) { return 'b'; }
+    if (is_fifo(fstat)) { return 'p'; }
+    if (is_socket(fstat)) { return 's'; }
+    if (is_other(fstat)) { return 'o'; }
+    if (is_regular_file(fstat)) { return '-'; }
+    return '?';
+}
+
+auto rwx(const fs::perms &p) -> string {
+    using fs::perms;
+    auto bit2char = [&p](perms bit, char c) { return (p & bit) == perms::none ? '-' : c; };
+    return {bit2char(perms::owner_read, 'r'),  bit2char(perms::owner_write, 'w'),  bit2char(perms::owner_exec, 'x'),
+            bit2char(perms::group_read, 'r'),  bit2char(perms::group_write, 'w'),  bit2char(perms::group_exec, 'x'),
+            bit2char(perms::others_read, 'r'), bit2char(perms::others_write, 'w'), bit2char(perms::others_exec, 'x')};
+}
+
+auto size_string(const uintmax_t fsize) -> string {
+    constexpr uintmax_t kilo{1024};
+    constexpr uintmax_t mega{kilo * kilo};
+    constexpr uintmax_t giga{mega * kilo};
+    if (fsize >= giga) { return format("{}{}", (fsize + giga / 2) / giga, 'G'); }
+    if (fsize >= mega) { return format("{}{}", (fsize + mega / 2) / mega, 'M'); }
+    if (fsize >= kilo) { return format("{}{}", (fsize + kilo / 2) / kilo, 'K'); }
+    return format("{}B", fsize);
+}
+
+void print_dir(const de &dir) {
+    using fs::perms;
+    const auto fpath{dir.path()};
+    const auto fstat{dir.symlink_status()};
+    const auto fperm{fstat.permissions()};
+    std::error_code ec{};
+    const uintmax_t fsize{is_regular_file(fstat) ? file_size(fpath, ec) : 0};
+    string suffix{};
+    if (is_symlink(fstat)) {
+        suffix = " -> " + fs::read_symlink(fpath, ec).string();
+    } else if (is_directory(fstat)) {
+        suffix = "/";
+    } else if ((fperm & perms::owner_exec) != perms::none) {
+        suffix = "*";
+    }
+    cout << format("{}{} {:>4} {}{}\n", type_char(fstat), rwx(fperm), size_string(fsize), fpath.filename().string(), suffix);
+}
+
+// 递归列出 root 下的所有文件：各线程把相对路径收集到自己的 vector，最后合并排序，输出与遍历顺序无关
+// root 本身是文件时输出它自己的路径
+auto list_recursive(const fs::path &root, ez::TaskPool &pool = ez::task_pool()) -> vector<string> {
+    vector<vector<string>> per_thread(pool.size());
+    ez::walk(std::span{&root, 1}, [&](const de &e, size_t, size_t thread) {
+        const fs::path &p{e.path()};
+        per_thread[thread].push_back(p == root ? p.string() : p.lexically_relative(root).string());
+    }, pool);
+
+    vector<string> all{};
+    for (auto &v : per_thread) { std::ranges::move(v, std::back_inserter(all)); }
+    ez::string_sort(all);
+    return all;
+}
+
+// 统计 files 个文件的生成目录树：单线程的 recursive_directory_iterator 与并行遍历
+auto bench(ez::bench::Runner &runner) -> int {
+    const size_t files{runner.count(0, 1'000'000)};
+    const auto tree{ez::make_tree(files)};
+    if (!tree) {
+        std::cerr << format("cannot create a test tree of {} files\n", files);
+        return 1;
+    }
+    const fs::path &root{*tree};
+
+    runner.run("10.4/count/recursive_directory_iterator", files, [&] {
+        size_t n{};
+        for (const auto &e : rdit{root}) { n += e.is_directory() ? 0 : 1; }
+        return n;
+    });
+    for (const size_t t : ez::bench_threads()) {
+        ez::TaskPool pool{t};
+        struct alignas(64) Count {
+            size_t n{};
+        };
+        runner.run(format("10.4/count/walk/{}", t), files, [&] {
+            vector<Count> counts(pool.size());
+            ez::walk(std::span{&root, 1}, [&](const de &, size_t, size_t thread) { ++counts[thread].n; }, pool);
+            size_t n{};
+            for (const auto &c : counts) { n += c.n; }
+            return n;
+        });
+    }
+    runner.run("10.4/list/walk+string_sort", files, [&] { return list_recursive(root).size(); });
+    return 0;
+}
+
+// 用法：1004 [path]        按 ls 的格式列出目录
+//       1004 -R [path]     并行递归列出所有文件
+//       1004 --bench [files]
+auto main(const int argc, char *argv[]) -> int {
+    if (ez::bench::requested(argc, argv)) {
+        ez::bench::Runner runner{argc, argv, {.warmup = 1, .runs = 5}};
+        return bench(runner);
+    }
+
+    const bool recursive{argc > 1 && string{argv[1]} == "-R"};
+    const int first{recursive ? 2 : 1};
+    const fs::path fp{argc > first ? argv[first] : "."};
+    if (!fs::exists(fp)) {
+        cout << format("{}: {} does not exist\n", fs::path{argv[0]}.filename().string(), fp.string());
+        return 1;
+    }
+    if (recursive) {
+        for (const auto &p : list_recursive(fp)) { cout << p << '\n'; }
+        return 0;
+    }
+    if (is_directory(fp)) {
+        vector<de> entries{};
+        for (const auto &e : fs::directory_iterator{fp}) { entries.emplace_back(e); }
+        std::ranges::sort(entries, dircmp_lc);
+        for (const auto &e : entries) { print_dir(e); }
+    } else {
+        print_dir(de{fp});
+    }
+}
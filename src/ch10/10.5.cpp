@@ -0,0 +1,227 @@
+/*
+ * @Author       : ExilsZ
+ * @LastEditor   : ExilsZ
+ * @Date         : 26-10-17 10:40
+ * @LastEditTime :
+ * @Description  : 使用 grep 实用程序搜索目录和文件
+ */
+
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <iostream>
+#include <regex>
+#include <span>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <vector>
+
+#include "ez/bench.h"
+#include "ez/walk.h"
+
+namespace fs = std::filesystem;
+using de = fs::directory_entry;
+using rdit = fs::recursive_directory_iterator;
+using match_v = std::vector<std::pair<size_t, std::string>>;
+
+using std::cout;
+using std::format;
+using std::regex;
+using std::string;
+using std::string_view;
+using std::vector;
+
+// 原来的实现：逐行读取，每一行都执行正则表达式
+auto matches(const fs::path &fpath, const regex &re) -> match_v {
+    match_v matches{};
+    std::ifstream instrm(fpath.string(), std::ios_base::in);
+    string s;
+    for (size_t lineno{1}; getline(instrm, s); ++lineno) {
+        if (std::regex_search(s.begin(), s.end(), re)) { matches.emplace_back(lineno, std::move(s)); }
+    }
+    return matches;
+}
+
+namespace ez {
+    // 正则表达式的任何匹配都必须以这个字面量开头：取模式开头直到第一个元字符的部分，
+    // 后面跟着 ? * { 的字符可以不出现，不计入；模式中有 | 时没有公共前缀，返回空串
+    inline auto literal_prefix(string_view pat) -> string {
+        constexpr string_view meta{".[]()*+?{}^$|\\"};
+        string lit{};
+        if (pat.find('|') != string_view::npos) { return lit; }
+        for (size_t i{pat.starts_with('^') ? 1U : 0U}; i < pat.size(); ++i) {
+            char c{pat[i]};
+            if (c == '\\') {
+                if (i + 1 == pat.size() || std::isalnum(static_cast<unsigned char>(pat[i + 1])) != 0) { break; } // \d \w 等字符类
+                c = pat[++i];
+            } else if (meta.find(c) != string_view::npos) {
+                break;
+            }
+            if (i + 1 < pat.size() && string_view{"?*{"}.find(pat[i + 1]) != string_view::npos) { break; }
+            lit += c;
+        }
+        return lit;
+    }
+
+    // 不区分大小写的 Horspool 字面量查找
+    class Prefilter {
+        string lit_{};
+        std::array<size_t, 256> skip_{};
+
+        static auto lower(char c) -> unsigned char { return static_cast<unsigned char>(std::tolower(static_cast<unsigned char>(c))); }
+
+      public:
+        explicit Prefilter(string_view literal) {
+            for (const char c : literal) { lit_ += static_cast<char>(lower(c)); }
+            skip_.fill(std::max<size_t>(1, lit_.size()));
+            for (size_t i{}; i + 1 < lit_.size(); ++i) {
+                const auto c{static_cast<unsigned char>(lit_[i])};
+                skip_[c] = lit_.size() - 1 - i;
+                skip_[static_cast<unsigned char>(std::toupper(c))] = lit_.size() - 1 - i;
+            }
+        }
+
+        [[nodiscard]] auto empty() const -> bool { return lit_.empty(); }
+
+        // 从 pos 开始第一次出现的位置
+        [[nodiscard]] auto find(string_view s, size_t pos) const -> size_t {
+            const size_t m{lit_.size()};
+            for (size_t i{pos}; i + m <= s.size(); i += skip_[static_cast<unsigned char>(s[i + m - 1])]) {
+                size_t j{m};
+                while (j > 0 && lower(s[i + j - 1]) == static_cast<unsigned char>(lit_[j - 1])) { --j; }
+                if (j == 0) { return i; }
+            }
+            return string_view::npos;
+        }
+    };
+
+    // 在整个文件内容中查找：有字面量时只对含有该字面量的行执行正则表达式，行号只在需要时统计
+    inline void grep(string_view data, const regex &re, const Prefilter &pf, match_v &out) {
+        auto line_at = [&](size_t b) { return std::min(data.find('\n', b), data.size()); };
+        auto search = [&](size_t b, size_t e) { return std::regex_search(data.data() + b, data.data() + e, re); };
+        if (pf.empty()) {
+            for (size_t b{}, lineno{1}; b < data.size(); ++lineno) {
+                const size_t e{line_at(b)};
+                if (search(b, e)) { out.emplace_back(lineno, string{data.substr(b, e - b)}); }
+                b = e + 1;
+            }
+            return;
+        }
+        size_t lineno{1};
+        size_t counted{}; // [0, counted) 中的换行已经计入 lineno
+        for (size_t hit{}; (hit = pf.find(data, hit)) != string_view::npos;) {
+            const size_t rb{data.rfind('\n', hit)};
+            const size_t b{rb == string_view::npos ? 0 : rb + 1};
+            const size_t e{line_at(hit)};
+            lineno += static_cast<size_t>(std::count(data.begin() + static_cast<std::ptrdiff_t>(counted),
+                                                     data.begin() + static_cast<std::ptrdiff_t>(b), '\n'));
+            counted = b;
+            if (search(b, e)) { out.emplace_back(lineno, string{data.substr(b, e - b)}); }
+            hit = e + 1;
+        }
+    }
+
+    struct GrepResult {
+        string path{};
+        size_t lineno{};
+        string line{};
+    };
+
+    // 并行搜索 roots 下的所有文件，结果按路径和行号排序；路径相对于各自的搜索目录
+    inline auto grep_tree(std::span<const fs::path> roots, const regex &re, string_view pattern, bool prefilter = true,
+                          TaskPool &pool = task_pool()) -> vector<GrepResult> {
+        const Prefilter pf{prefilter ? literal_prefix(pattern) : ""};
+        vector<vector<GrepResult>> per_thread(pool.size());
+        walk(roots, [&](const de &e, size_t root, size_t thread) {
+            std::error_code ec{};
+            if (!e.is_regular_file(ec)) { return; }
+            const MappedFile file{e.path()};
+            thread_local match_v found{};
+            found.clear();
+            grep(file.data(), re, pf, found);
+            if (found.empty()) { return; }
+            const string target{e.path() == roots[root] ? e.path().string() : e.path().lexically_relative(roots[root]).string()};
+            for (auto &[lineno, line] : found) { per_thread[thread].push_back({target, lineno, std::move(line)}); }
+        }, pool);
+
+        vector<GrepResult> all{};
+        for (auto &v : per_thread) { std::ranges::move(v, std::back_inserter(all)); }
+        std::ranges::sort(all, {}, [](const GrepResult &r) { return std::tie(r.path, r.lineno); });
+        return all;
+    }
+} // namespace ez
+
+// 在生成的目录树中查找 needle：原来的逐行 regex 与并行的 mmap + 字面量预筛选
+auto bench(ez::bench::Runner &runner) -> int {
+    const size_t files{runner.count(0, 1'000'000)};
+    const string pattern{runner.arg(1, "needle")};
+    const auto tree{ez::make_tree(files)};
+    if (!tree) {
+        std::cerr << format("cannot create a test tree of {} files\n", files);
+        return 1;
+    }
+    const fs::path &root{*tree};
+    const regex re{pattern, std::regex_constants::icase};
+
+    size_t expected{};
+    runner.run("10.5/grep/ifstream+regex", files, [&] {
+        size_t n{};
+        for (const auto &e : rdit{root}) {
+            if (e.is_regular_file()) { n += matches(e.path(), re).size(); }
+        }
+        return expected = n;
+    });
+    const std::span roots{&root, 1};
+    for (const size_t t : ez::bench_threads()) {
+        ez::TaskPool pool{t};
+        size_t n{};
+        runner.run(format("10.5/grep/walk+mmap+prefilter/{}", t), files, [&] {
+            return n = ez::grep_tree(roots, re, pattern, true, pool).size();
+        });
+        std::cerr << format("threads {} matches {}\n", t, n == expected ? "match" : "DIFFER");
+    }
+    runner.run("10.5/grep/walk+mmap, no prefilter", files, [&] { return ez::grep_tree(roots, re, pattern, false).size(); });
+    return 0;
+}
+
+// 用法：1005 pattern [path/file ...]
+//       1005 --bench [files] [pattern]
+auto main(const int argc, char *argv[]) -> int {
+    if (ez::bench::requested(argc, argv)) {
+        ez::bench::Runner runner{argc, argv, {.warmup = 1, .runs = 3}};
+        return bench(runner);
+    }
+
+    if (argc < 2) {
+        cout << format("usage: {} pattern [path/file]\n", fs::path(argv[0]).filename().string());
+        return 1;
+    }
+
+    const string_view arg_pat{argv[1]};
+    regex re{};
+    try {
+        re = regex(arg_pat.begin(), arg_pat.end(), std::regex_constants::icase);
+    } catch (const std::regex_error &e) {
+        cout << format("{}: {}\n", e.what(), arg_pat);
+        return 1;
+    }
+
+    vector<fs::path> roots{};
+    for (int i{2}; i < argc; ++i) {
+        fs::path p{argv[i]};
+        if (!fs::exists(p)) {
+            cout << format("not found: {}\n", p.string());
+            continue;
+        }
+        roots.push_back(std::move(p));
+    }
+    if (argc == 2) { roots.emplace_back("."); }
+
+    const auto results{ez::grep_tree(roots, re, arg_pat)};
+    for (const auto &[path, lineno, line] : results) { cout << format("{} {}: {}\n", path, lineno, line); }
+    cout << format("found {} matches\n", results.size());
+}
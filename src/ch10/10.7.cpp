@@ -0,0 +1,157 @@
+/*
+ * @Author       : ExilsZ
+ * @LastEditor   : ExilsZ
+ * @Date         : 26-10-17 11:05
+ * @LastEditTime :
+ * @Description  : 创建磁盘使用计数器
+ */
+
+#include <algorithm>
+#include <cstdint>
+#include <filesystem>
+#include <format>
+#include <iostream>
+#include <span>
+#include <string>
+#include <system_error>
+#include <vector>
+
+#include "ez/bench.h"
+#include "ez/grouped.h"
+#include "ez/walk.h"
+
+namespace fs = std::filesystem;
+using dit = fs::directory_iterator;
+using de = fs::directory_entry;
+
+using std::cout;
+using std::format;
+using std::string;
+using std::vector;
+
+auto strlower(string s) -> string {
+    std::ranges::transform(s, s.begin(), [](char c) { return c >= 'A' && c <= 'Z' ? static_cast<char>(c + ('a' - 'A')) : c; });
+    return s;
+}
+
+auto dircmp_lc(const de &lhs, const de &rhs) -> bool {
+    return strlower(lhs.path().string()) < strlower(rhs.path().string());
+}
+
+auto size_string(const uintmax_t fsize) -> string {
+    constexpr uintmax_t kilo{1024};
+    constexpr uintmax_t mega{kilo * kilo};
+    constexpr uintmax_t giga{mega * kilo};
+    if (fsize >= giga) { return format("{}{}", (fsize + giga / 2) / giga, 'G'); }
+    if (fsize >= mega) { return format("{}{}", (fsize + mega / 2) / mega, 'M'); }
+    if (fsize >= kilo) { return format("{}{}", (fsize + kilo / 2) / kilo, 'K'); }
+    return format("{}B", fsize);
+}
+
+// 原来的实现：递归计算一个文件或目录的大小，不进入符号链接指向的目录
+auto entry_size(const fs::path &p) -> uintmax_t {
+    if (fs::is_regular_file(p)) { return fs::file_size(p); }
+    uintmax_t accum{};
+    if (fs::is_directory(p) && !fs::is_symlink(p)) {
+        for (const auto &e : dit{p}) { accum += entry_size(e.path()); }
+    }
+    return accum;
+}
+
+namespace ez {
+    // 并行计算 paths 中每一项的大小：每个线程累加到自己的一行计数中，结束后按列求和，遍历过程中不加锁
+    // 所有行放在一块数组中，行宽向上取整到 64 字节并按 64 字节对齐，相邻线程的行不会落在同一个缓存行
+    inline auto entry_sizes(std::span<const fs::path> paths, TaskPool &pool = task_pool()) -> vector<uintmax_t> {
+        constexpr size_t cache_line{64};
+        constexpr size_t per_line{cache_line / sizeof(uintmax_t)};
+        struct alignas(cache_line) Line {
+            uintmax_t sizes[per_line]{};
+        };
+        const size_t stride{(paths.size() + per_line - 1) / per_line}; // 每行的缓存行数
+        vector<Line> lines(pool.size() * stride);
+        auto at = [&](size_t thread, size_t root) -> uintmax_t & {
+            return lines[thread * stride + root / per_line].sizes[root % per_line];
+        };
+        walk(paths, [&](const de &e, size_t root, size_t thread) {
+            std::error_code ec{};
+            if (e.is_regular_file(ec)) { at(thread, root) += e.file_size(ec); }
+        }, pool);
+
+        vector<uintmax_t> total(paths.size());
+        for (size_t t{}; t < pool.size(); ++t) {
+            for (size_t i{}; i < total.size(); ++i) { total[i] += at(t, i); }
+        }
+        return total;
+    }
+} // namespace ez
+
+// 生成的目录树的总大小：原来的递归 entry_size 与并行遍历
+auto bench(ez::bench::Runner &runner) -> int {
+    const size_t files{runner.count(0, 1'000'000)};
+    const auto tree{ez::make_tree(files)};
+    if (!tree) {
+        std::cerr << format("cannot create a test tree of {} files\n", files);
+        return 1;
+    }
+    const fs::path &root{*tree};
+    vector<fs::path> children{};
+    for (const auto &e : dit{root}) { children.push_back(e.path()); }
+
+    uintmax_t expected{};
+    runner.run("10.7/du/entry_size", files, [&] {
+        uintmax_t n{};
+        for (const auto &c : children) { n += entry_size(c); }
+        return expected = n;
+    });
+    for (const size_t t : ez::bench_threads()) {
+        ez::TaskPool pool{t};
+        uintmax_t n{};
+        runner.run(format("10.7/du/walk/{}", t), files, [&] {
+            const auto sizes{ez::entry_sizes(children, pool)};
+            n = 0;
+            for (const auto s : sizes) { n += s; }
+            return n;
+        });
+        std::cerr << format("threads {} total {}\n", t, n == expected ? "match" : "DIFFER");
+    }
+    return 0;
+}
+
+// 用法：1007 [dir]
+//       1007 --bench [files]
+auto main(const int argc, char *argv[]) -> int {
+    if (ez::bench::requested(argc, argv)) {
+        ez::bench::Runner runner{argc, argv, {.warmup = 1, .runs = 3}};
+        return bench(runner);
+    }
+
+    const auto dir{argc > 1 ? fs::path(argv[1]) : fs::current_path()};
+    if (!exists(dir)) {
+        cout << format("path {} does not exist\n", dir.string());
+        return 1;
+    }
+    if (!is_directory(dir)) {
+        cout << format("{} is not a directory\n", dir.string());
+        return 1;
+    }
+    cout << format("{}:\n", absolute(dir).string());
+
+    vector<de> entries{};
+    for (const auto &e : dit{dir}) { entries.emplace_back(e.path()); }
+    std::ranges::sort(entries, dircmp_lc);
+
+    // 所有顶层项一起交给线程池，大小不同的子目录之间也能均衡负载
+    vector<fs::path> paths{};
+    for (const auto &e : entries) { paths.push_back(e.path()); }
+    const auto sizes{ez::entry_sizes(paths)};
+
+    uintmax_t accum{};
+    for (size_t i{}; i < entries.size(); ++i) {
+        const fs::path &p{paths[i]};
+        accum += sizes[i];
+        const string dir_flag{is_directory(p) && !is_symlink(p) ? " ▽" : ""};
+        cout << format("{:>5} {}{}\n", size_string(sizes[i]), p.filename().string(), dir_flag);
+    }
+    cout << format("{:->25}\n", "");
+    cout << format("total bytes: {} ({})\n", ez::grouped{accum}, size_string(accum));
+}
@@ -0,0 +1,705 @@
+/*
+ * @Author       : ExilsZ
+ * @LastEditor   : ExilsZ
+ * @Date         : 26-10-17 11:40
+ * @LastEditTime :
+ * @Description  : 为搜索建议创建一个 trie 类
+ */
+
+#include <algorithm>
+#include <cctype>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <initializer_list>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <numeric>
+#include <optional>
+#include <random>
+#include <ranges>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "ez/alloc_counter.h"
+#include "ez/bench.h"
+#include "ez/mapped_file.h"
+#include "ez/small_vector.h"
+#include "ez/string_map.h"
+
+namespace fs = std::filesystem;
+
+using std::cout;
+using std::format;
+using std::string;
+using std::string_view;
+using std::vector;
+
+using ilcstr = std::initializer_list<const char *>;
+
+// 原来的实现：每个节点是一个 std::map<string, trie>，结果复制到 deque 中返回
+namespace bw {
+    using std::deque;
+    using std::map;
+
+    class trie {
+        using get_t = deque<deque<string>>;
+        using nodes_t = map<string, trie>;
+        using result_t = std::optional<const trie *>;
+
+        nodes_t nodes{};
+        mutable get_t result_dq{};
+        mutable deque<string> prefix_dq{};
+
+        template <typename It>
+        void _insert(It it, It end_it) {
+            if (it == end_it) { return; }
+            auto &next{nodes[*it]};
+            next._insert(++it, end_it);
+        }
+
+        void _get(deque<string> &dq, get_t &r_dq) const {
+            if (empty()) {
+                r_dq.emplace_back(dq);
+                dq.clear();
+            }
+            for (const auto &p : nodes) {
+                dq.emplace_back(p.first);
+                p.second._get(dq, r_dq);
+            }
+        }
+
+        void _find_prefix(const string &s, auto &pre_dq) const {
+            if (empty()) { return; }
+            for (const auto &[k, v] : nodes) {
+                if (k.starts_with(s)) {
+                    pre_dq.emplace_back(k);
+                    v._find_prefix(k, pre_dq);
+                }
+            }
+        }
+
+        template <typename It>
+        auto _search(It it, It end_it) const -> result_t {
+            if (it == end_it) { return {this}; }
+            auto found_it{nodes.find(*it)};
+            if (found_it == nodes.end()) { return {}; }
+            return found_it->second._search(++it, end_it);
+        }
+
+      public:
+        void insert(const ilcstr &il) { _insert(il.begin(), il.end()); }
+
+        // 基准测试用：单词来自任意范围
+        template <std::ranges::input_range R>
+        void insert_range(R &&r) {
+            _insert(std::ranges::begin(r), std::ranges::end(r));
+        }
+
+        auto get() const -> get_t & {
+            result_dq.clear();
+            deque<string> dq{};
+            _get(dq, result_dq);
+            return result_dq;
+        }
+
+        auto find_prefix(const char *s) const -> deque<string> & {
+            _find_prefix(s, prefix_dq);
+            return prefix_dq;
+        }
+
+        auto search(const ilcstr &il) const -> result_t { return _search(il.begin(), il.end()); }
+
+        auto search(const string &s) const -> result_t {
+            const ilcstr il{s.c_str()};
+            return _search(il.begin(), il.end());
+        }
+
+        template <std::ranges::input_range R>
+        auto search_range(R &&r) const -> result_t {
+            return _search(std::ranges::begin(r), std::ranges::end(r));
+        }
+
+        [[nodiscard]] auto empty() const -> bool { return nodes.empty(); }
+
+        // 节点数（不含根）
+        [[nodiscard]] auto size() const -> size_t {
+            size_t n{nodes.size()};
+            for (const auto &p : nodes) { n += p.second.size(); }
+            return n;
+        }
+    };
+} // namespace bw
+
+void print_trie_prefix(const bw::trie &t, const string &prefix) {
+    auto &trie_strings{t.get()};
+    cout << format("results for \"{}...\":\n", prefix);
+    for (auto &dq : trie_strings) {
+        cout << format("{} ", prefix);
+        for (const auto &s : dq) { cout << format("{} ", s); }
+        cout << '\n';
+    }
+}
+
+void print_trie_prefix(const bw::trie &t, const ilcstr &prefix) {
+    string sprefix{};
+    for (const auto &s : prefix) { sprefix += format("{} ", s); }
+    print_trie_prefix(t, sprefix);
+}
+
+namespace ez {
+    // 按空白切分单词，结果指向 line
+    inline void split_words(string_view line, vector<string_view> &out) {
+        out.clear();
+        auto space = [](char c) { return std::isspace(static_cast<unsigned char>(c)) != 0; };
+        for (size_t b{}; b < line.size();) {
+            if (space(line[b])) {
+                ++b;
+                continue;
+            }
+            size_t e{b};
+            while (e < line.size() && !space(line[e])) { ++e; }
+            out.push_back(line.substr(b, e - b));
+            b = e;
+        }
+    }
+
+    // 冻结的 trie：全部数据在一块连续的 uint32_t 数组中，可以原样写入文件，之后用 mmap 打开，不需要重建
+    // 布局（以 uint32_t 计）：头部 | first[N+1] | word[N] | term[(N+31)/32] | woff[W+1] | 字符池
+    // 节点按广度优先编号，根为 0，靠近根的节点集中在数组开头；节点 n 的子节点是 [first[n], first[n+1])
+    // 单词编号按字典序分配，word[n] 是节点 n 的单词编号，所以子节点也按字典序排列，可以二分查找
+    // 单词 i 是字符池中的 [woff[i], woff[i+1])，每个不同的单词只保存一次；文件使用本机字节序
+    class CompactTrie {
+        static constexpr uint32_t magic{0x52545a45}; // "EZTR"
+        static constexpr uint32_t version{1};
+        static constexpr size_t header_size{5};      // magic version N W 字符池字节数
+
+        std::vector<uint32_t> own_{};      // freeze() 生成的数据
+        std::unique_ptr<MappedFile> file_{}; // open() 映射的文件
+        std::span<const uint32_t> blob_{};
+        std::span<const uint32_t> first_{};
+        std::span<const uint32_t> word_{};
+        std::span<const uint32_t> term_{};
+        std::span<const uint32_t> woff_{};
+        string_view pool_{};
+
+        static constexpr auto blob_size(size_t nodes, size_t words, size_t pool) -> size_t {
+            return header_size + (nodes + 1) + nodes + (nodes + 31) / 32 + (words + 1) + (pool + 3) / 4;
+        }
+
+        // 按头部划分各个数组，只检查头部和各段长度；文件中的内容由 valid() 检查
+        auto attach(std::span<const uint32_t> blob) -> bool {
+            if (blob.size() < header_size || blob[0] != magic || blob[1] != version) { return false; }
+            const size_t n{blob[2]};
+            const size_t w{blob[3]};
+            const size_t p{blob[4]};
+            if (n == 0 || blob.size() != blob_size(n, w, p)) { return false; }
+            size_t at{header_size};
+            auto take = [&](size_t k) {
+                const auto s{blob.subspan(at, k)};
+                at += k;
+                return s;
+            };
+            first_ = take(n + 1);
+            word_ = take(n);
+            term_ = take((n + 31) / 32);
+            woff_ = take(w + 1);
+            if (first_.back() != n || woff_.back() != p) { return false; }
+            pool_ = {reinterpret_cast<const char *>(blob.data() + at), p};
+            blob_ = blob;
+            return true;
+        }
+
+        // 逐项检查下标，保证查询不会越界或陷入循环：子节点编号大于父节点且各段不重叠，单词编号和字符池偏移都在范围内
+        // 只做顺序扫描，比重新构建快得多；不检查子节点是否按字典序排列，顺序错误只影响查找结果
+        [[nodiscard]] auto valid() const -> bool {
+            const size_t n{word_.size()};
+            const size_t w{woff_.size() - 1};
+            if (first_[0] != 1 || woff_[0] != 0) { return false; }
+            for (size_t i{}; i < n; ++i) {
+                if (first_[i] <= i || first_[i] > first_[i + 1]) { return false; }
+            }
+            for (size_t i{1}; i < n; ++i) {
+                if (word_[i] >= w) { return false; }
+            }
+            for (size_t i{}; i < w; ++i) {
+                if (woff_[i] > woff_[i + 1]) { return false; }
+            }
+            return true;
+        }
+
+        // 深度优先按字典序访问 n 之下（含 n）的短语，path 中已有从根到 n 的单词
+        // 用显式的栈代替递归，很长的短语（一长串单子节点）不会耗尽调用栈；栈的第 k 层是 path 中第 k 个新单词之下尚未访问的子节点
+        template <typename F>
+        void complete(uint32_t n, F &f, small_vector<string_view, 16> &path, size_t &left) const {
+            if (terminal(n)) {
+                f(std::span<const string_view>{path.data(), path.size()});
+                if (--left == 0) { return; }
+            }
+            const size_t base{path.size()};
+            small_vector<std::pair<uint32_t, uint32_t>, 16> stack{};
+            stack.push_back({first_[n], first_[n + 1]});
+            while (!stack.empty()) {
+                auto &[next, end]{stack.back()};
+                if (next == end) {
+                    stack.pop_back();
+                    if (!stack.empty()) { path.pop_back(); }
+                    continue;
+                }
+                const uint32_t c{next++};
+                path.push_back(word(c));
+                if (terminal(c)) {
+                    f(std::span<const string_view>{path.data(), path.size()});
+                    if (--left == 0) { break; }
+                }
+                stack.push_back({first_[c], first_[c + 1]});
+            }
+            while (path.size() > base) { path.pop_back(); }
+        }
+
+        friend class TrieBuilder;
+
+      public:
+        static constexpr uint32_t npos{~uint32_t{}};
+
+        CompactTrie() = default;
+        CompactTrie(CompactTrie &&) noexcept = default;
+        auto operator=(CompactTrie &&) noexcept -> CompactTrie & = default;
+        // 各个 span 指向自己的数据，不能复制
+        CompactTrie(const CompactTrie &) = delete;
+        auto operator=(const CompactTrie &) -> CompactTrie & = delete;
+        ~CompactTrie() = default;
+
+        // 映射 save() 写出的文件，检查一遍下标后即可查询，不需要重建；格式不符或内容损坏时返回空
+        static auto open(const fs::path &p) -> std::optional<CompactTrie> {
+            CompactTrie t{};
+            t.file_ = std::make_unique<MappedFile>(p);
+            const string_view data{t.file_->data()};
+            if (data.size() % sizeof(uint32_t) != 0 || reinterpret_cast<uintptr_t>(data.data()) % alignof(uint32_t) != 0) {
+                return std::nullopt;
+            }
+            if (!t.attach({reinterpret_cast<const uint32_t *>(data.data()), data.size() / sizeof(uint32_t)}) || !t.valid()) {
+                return std::nullopt;
+            }
+            return t;
+        }
+
+        auto save(const fs::path &p) const -> bool {
+            std::FILE *f{std::fopen(p.string().c_str(), "wb")};
+            if (f == nullptr) { return false; }
+            const bool ok{std::fwrite(blob_.data(), 1, blob_.size_bytes(), f) == blob_.size_bytes()};
+            return std::fclose(f) == 0 && ok;
+        }
+
+        [[nodiscard]] auto size() const -> size_t { return word_.size(); }                 // 节点数，含根
+        [[nodiscard]] auto words() const -> size_t { return woff_.empty() ? 0 : woff_.size() - 1; } // 不同单词数
+        [[nodiscard]] auto bytes() const -> size_t { return blob_.size_bytes(); }
+
+        [[nodiscard]] auto word(uint32_t n) const -> string_view {
+            const uint32_t w{word_[n]};
+            return pool_.substr(woff_[w], woff_[w + 1] - woff_[w]);
+        }
+
+        // 是否有短语在节点 n 结束
+        [[nodiscard]] auto terminal(uint32_t n) const -> bool { return ((term_[n / 32] >> (n % 32)) & 1U) != 0; }
+
+        [[nodiscard]] auto children(uint32_t n) const { return std::views::iota(first_[n], first_[n + 1]); }
+
+        [[nodiscard]] auto child(uint32_t n, string_view w) const -> uint32_t {
+            const auto kids{children(n)};
+            const auto it{std::ranges::lower_bound(kids, w, {}, [this](uint32_t c) { return word(c); })};
+            return it != kids.end() && word(*it) == w ? *it : npos;
+        }
+
+        // 单词以 partial 开头的子节点：子节点有序，它们是连续的一段
+        [[nodiscard]] auto starting_with(uint32_t n, string_view partial) const {
+            const auto kids{children(n)};
+            const auto b{std::ranges::lower_bound(kids, partial, {}, [this](uint32_t c) { return word(c); })};
+            const auto e{std::ranges::partition_point(b, kids.end(), [&](uint32_t c) { return word(c).starts_with(partial); })};
+            return std::ranges::subrange(b, e);
+        }
+
+        // 从根沿 words 走到的节点，不存在时返回 npos
+        template <std::ranges::input_range R>
+        [[nodiscard]] auto find(R &&words) const -> uint32_t {
+            uint32_t n{};
+            for (const string_view w : words) {
+                if ((n = child(n, w)) == npos) { break; }
+            }
+            return n;
+        }
+
+        [[nodiscard]] auto find(std::initializer_list<string_view> words) const -> uint32_t { return find(std::span{words}); }
+
+        // 对节点 n 之下（含 n）的每个短语按字典序调用 f(tail)，tail 是 n 之后的单词，最多 limit 个，返回调用次数
+        // tail 中的 string_view 指向 trie 的字符池，与 trie 同生命期；查询过程中不复制字符串
+        template <typename F>
+        auto for_each_completion(uint32_t n, F &&f, size_t limit = npos) const -> size_t {
+            if (n == npos || limit == 0) { return 0; }
+            small_vector<string_view, 16> path{};
+            size_t left{limit};
+            complete(n, f, path, left);
+            return limit - left;
+        }
+
+        // 搜索建议：query 中除最后一个单词外必须完整匹配，最后一个单词作为前缀（query 以空白结尾时没有前缀）
+        // 对每个候选短语调用 f(phrase)，phrase 是从根开始的完整短语，最多 limit 个，返回调用次数
+        template <typename F>
+        auto suggest(string_view query, F &&f, size_t limit = 10) const -> size_t {
+            thread_local vector<string_view> words{};
+            split_words(query, words);
+            const bool open_end{query.empty() || std::isspace(static_cast<unsigned char>(query.back())) != 0};
+            const string_view partial{open_end || words.empty() ? string_view{} : words.back()};
+            if (!open_end && !words.empty()) { words.pop_back(); }
+
+            small_vector<string_view, 16> path{};
+            uint32_t n{};
+            for (const string_view w : words) {
+                if ((n = child(n, w)) == npos) { return 0; }
+                path.push_back(word(n));
+            }
+            size_t left{limit};
+            if (limit == 0) { return 0; }
+            if (open_end) {
+                complete(n, f, path, left);
+                return limit - left;
+            }
+            for (const uint32_t c : starting_with(n, partial)) {
+                path.push_back(word(c));
+                complete(c, f, path, left);
+                path.pop_back();
+                if (left == 0) { break; }
+            }
+            return limit - left;
+        }
+    };
+
+    // 收集短语，freeze() 生成 CompactTrie；单词在插入时去重并编号
+    class TrieBuilder {
+        unordered_string_map<uint32_t> ids_{};
+        vector<string_view> words_{}; // 编号 -> 单词，指向 ids_ 中的键，节点容器中键的地址不会改变
+        vector<uint32_t> tokens_{};   // 所有短语的单词编号依次相连
+        vector<uint32_t> ends_{};     // 每个短语在 tokens_ 中的结束位置
+
+      public:
+        template <std::ranges::input_range R>
+        void insert(R &&phrase) {
+            for (const string_view w : phrase) {
+                auto it{ids_.find(w)};
+                if (it == ids_.end()) {
+                    it = ids_.emplace(string{w}, static_cast<uint32_t>(words_.size())).first;
+                    words_.emplace_back(it->first);
+                }
+                tokens_.push_back(it->second);
+            }
+            ends_.push_back(static_cast<uint32_t>(tokens_.size()));
+        }
+
+        void insert(std::initializer_list<string_view> phrase) { insert(std::span{phrase}); }
+
+        [[nodiscard]] auto phrases() const -> size_t { return ends_.size(); }
+
+        [[nodiscard]] auto freeze() const -> CompactTrie {
+            // 单词按字典序重新编号，子节点按编号排列即按字典序排列
+            vector<uint32_t> order(words_.size());
+            std::iota(order.begin(), order.end(), 0U);
+            std::ranges::sort(order, {}, [this](uint32_t i) { return words_[i]; });
+            vector<uint32_t> rank(words_.size());
+            for (uint32_t i{}; i < order.size(); ++i) { rank[order[i]] = i; }
+            vector<uint32_t> tokens(tokens_.size());
+            std::ranges::transform(tokens_, tokens.begin(), [&](uint32_t t) { return rank[t]; });
+
+            // 短语按字典序排序后，以同一前缀开头的短语相邻，短的在前
+            vector<std::span<const uint32_t>> phrases{};
+            phrases.reserve(ends_.size());
+            for (uint32_t b{}; const uint32_t e : ends_) {
+                phrases.emplace_back(tokens.data() + b, e - b);
+                b = e;
+            }
+            std::ranges::sort(phrases, [](auto a, auto b) { return std::ranges::lexicographical_compare(a, b); });
+
+            // 广度优先建立节点：节点 n 对应 phrases[begin, end) 的第 depth 个单词之前的公共前缀
+            // 处理节点的顺序就是编号顺序，所以每个节点的子节点编号连续，且紧接在前一个节点的子节点之后
+            struct Range {
+                uint32_t begin, end, depth;
+            };
+            vector<Range> ranges{{0, static_cast<uint32_t>(phrases.size()), 0}};
+            vector<uint32_t> first{};
+            vector<uint32_t> word{0};
+            vector<uint32_t> term{};
+            for (uint32_t n{}; n < ranges.size(); ++n) {
+                first.push_back(static_cast<uint32_t>(ranges.size()));
+                auto [b, e, d]{ranges[n]};
+                if (n % 32 == 0) { term.push_back(0); }
+                for (; b < e && phrases[b].size() == d; ++b) { term.back() |= 1U << (n % 32); }
+                while (b < e) {
+                    const uint32_t w{phrases[b][d]};
+                    uint32_t g{b + 1};
+                    while (g < e && phrases[g][d] == w) { ++g; }
+                    ranges.push_back({b, g, d + 1});
+                    word.push_back(w);
+                    b = g;
+                }
+            }
+            first.push_back(static_cast<uint32_t>(ranges.size()));
+
+            vector<uint32_t> woff{0};
+            string pool{};
+            for (const uint32_t i : order) {
+                pool += words_[i];
+                woff.push_back(static_cast<uint32_t>(pool.size()));
+            }
+
+            const size_t n{word.size()};
+            CompactTrie t{};
+            t.own_.reserve(CompactTrie::blob_size(n, words_.size(), pool.size()));
+            t.own_.insert(t.own_.end(), {CompactTrie::magic, CompactTrie::version, static_cast<uint32_t>(n),
+                                         static_cast<uint32_t>(words_.size()), static_cast<uint32_t>(pool.size())});
+            for (const auto *v : {&first, &word, &term, &woff}) { t.own_.insert(t.own_.end(), v->begin(), v->end()); }
+            const size_t at{t.own_.size()};
+            t.own_.resize(at + (pool.size() + 3) / 4);
+            std::memcpy(t.own_.data() + at, pool.data(), pool.size());
+            t.attach(t.own_);
+            return t;
+        }
+    };
+} // namespace ez
+
+void print_suggestions(const ez::CompactTrie &t, string_view query, size_t limit = 10) {
+    cout << format("suggestions for \"{}\":\n", query);
+    t.suggest(query, [](std::span<const string_view> phrase) {
+        for (const auto w : phrase) { cout << format("{} ", w); }
+        cout << '\n';
+    }, limit);
+}
+
+// 合成语料：按平方分布抽取单词，常用词集中在前面，短语之间共享前缀
+// 短语长度由首个单词的拼写决定，没有短语是另一个短语的真前缀，两种实现的结果数可以直接比较
+struct Corpus {
+    vector<string> vocab{};
+    vector<uint32_t> tokens{};
+    vector<uint32_t> ends{};
+
+    [[nodiscard]] auto phrase(size_t i, size_t k = ~size_t{}) const {
+        const uint32_t b{i == 0 ? 0 : ends[i - 1]};
+        return std::span{tokens}.subspan(b, std::min<size_t>(k, ends[i] - b)) |
+               std::views::transform([this](uint32_t w) -> const string & { return vocab[w]; });
+    }
+};
+
+auto make_corpus(size_t phrases, size_t vocab_size) -> Corpus {
+    constexpr string_view syllables[]{"ka", "lo", "mi", "ne", "ru", "sa", "ti", "vo", "be", "do", "fu", "ga", "hi", "ja", "pe", "zu"};
+    std::mt19937 rng{11};
+    Corpus c{};
+    for (size_t i{}; i < vocab_size; ++i) {
+        string w{};
+        for (size_t s{}, n{2 + rng() % 3}; s < n; ++s) { w += syllables[rng() % std::size(syllables)]; }
+        c.vocab.push_back(std::move(w));
+    }
+    std::uniform_real_distribution<double> u{0.0, 1.0};
+    auto pick = [&] { const double x{u(rng)}; return static_cast<uint32_t>(x * x * static_cast<double>(vocab_size)); };
+    for (size_t i{}; i < phrases; ++i) {
+        const uint32_t head{pick()};
+        c.tokens.push_back(head);
+        for (size_t k{1}, len{2 + c.vocab[head].size() % 5}; k < len; ++k) { c.tokens.push_back(pick()); }
+        c.ends.push_back(static_cast<uint32_t>(c.tokens.size()));
+    }
+    return c;
+}
+
+// 10^6 个短语：std::map 递归 trie 与冻结的 CompactTrie 的构建、每节点内存、查找和建议延迟、mmap 打开
+void bench(ez::bench::Runner &runner) {
+    const size_t phrases{std::max<size_t>(1, runner.count(0, 1'000'000))};
+    const size_t queries{runner.count(1, 100'000)};
+    const Corpus corpus{make_corpus(phrases, 50'000)};
+
+    auto build_map = [&] {
+        bw::trie t{};
+        for (size_t i{}; i < phrases; ++i) { t.insert_range(corpus.phrase(i)); }
+        return t;
+    };
+    auto build_compact = [&] {
+        ez::TrieBuilder b{};
+        for (size_t i{}; i < phrases; ++i) { b.insert(corpus.phrase(i)); }
+        return b.freeze();
+    };
+    runner.run("11.2/build/std::map", phrases, [&] { return build_map().empty(); });
+    runner.run("11.2/build/compact", phrases, [&] { return build_compact().size(); });
+
+    const ez::alloc::Scope scope{};
+    const bw::trie map_trie{build_map()};
+    const size_t map_bytes{scope.allocated_bytes()};
+    const ez::CompactTrie trie{build_compact()};
+    const size_t map_nodes{map_trie.size()};
+    // 每个 bw::trie 都有两个 mutable deque 成员，libstdc++ 中空的 deque 也会分配一块缓冲区
+    std::cerr << format("std::map: {} nodes, {} bytes allocated, {:.1f} bytes/node\n", map_nodes, map_bytes,
+                   static_cast<double>(map_bytes) / static_cast<double>(map_nodes));
+    std::cerr << format("compact:  {} nodes, {} words, {} bytes, {:.1f} bytes/node\n", trie.size() - 1, trie.words(), trie.bytes(),
+                   static_cast<double>(trie.bytes()) / static_cast<double>(trie.size() - 1));
+
+    // 查询取语料中短语的前 1~2 个单词
+    std::mt19937 rng{5};
+    vector<std::pair<size_t, size_t>> qs(queries);
+    for (auto &[i, k] : qs) { i = rng() % phrases, k = 1 + rng() % 2; }
+
+    size_t found_map{};
+    size_t found_compact{};
+    runner.run("11.2/search/std::map", queries, [&] {
+        found_map = 0;
+        for (const auto &[i, k] : qs) { found_map += map_trie.search_range(corpus.phrase(i, k)) ? 1 : 0; }
+        return found_map;
+    });
+    runner.run("11.2/search/compact", queries, [&] {
+        found_compact = 0;
+        for (const auto &[i, k] : qs) { found_compact += trie.find(corpus.phrase(i, k)) != ez::CompactTrie::npos ? 1 : 0; }
+        return found_compact;
+    });
+    std::cerr << format("search {}\n", found_map == found_compact ? "match" : "DIFFER");
+
+    // 前缀下的全部短语：get() 复制到 deque，for_each_completion 只给出指向字符池的 string_view
+    // 常用词开头的前缀下有上千个短语，get() 很慢，只取前 1/10 的查询
+    const std::span few{qs.data(), qs.size() / 10};
+    runner.run("11.2/complete/std::map get()", few.size(), [&] {
+        found_map = 0;
+        for (const auto &[i, k] : few) {
+            if (const auto st{map_trie.search_range(corpus.phrase(i, k))}) { found_map += (*st)->get().size(); }
+        }
+        return found_map;
+    });
+    runner.run("11.2/complete/compact", few.size(), [&] {
+        found_compact = 0;
+        for (const auto &[i, k] : few) {
+            found_compact += trie.for_each_completion(trie.find(corpus.phrase(i, k)), [](std::span<const string_view> tail) {
+                ez::bench::do_not_optimize(tail);
+            });
+        }
+        return found_compact;
+    });
+    std::cerr << format("completions {}\n", found_map == found_compact ? "match" : "DIFFER");
+    runner.run("11.2/complete/compact top 10", queries, [&] {
+        size_t n{};
+        for (const auto &[i, k] : qs) {
+            n += trie.for_each_completion(trie.find(corpus.phrase(i, k)), [](std::span<const string_view> tail) {
+                ez::bench::do_not_optimize(tail);
+            }, 10);
+        }
+        return n;
+    });
+
+    // 启动：打开冻结文件并完成一次查询，与重新构建比较
+    const fs::path file{fs::temp_directory_path() / "ez_trie_bench.trie"};
+    if (!trie.save(file)) {
+        std::cerr << format("cannot write {}\n", file.string());
+        return;
+    }
+    runner.run("11.2/startup/open mmap", 1, [&] {
+        const auto t{ez::CompactTrie::open(file)};
+        return t ? t->find(corpus.phrase(0, 1)) : ez::CompactTrie::npos;
+    });
+    fs::remove(file);
+}
+
+// 用法：1102                          书中的示例
+//       1102 build phrases.txt out.trie 每行一个短语，冻结后写入文件
+//       1102 suggest file.trie words...  映射文件并给出搜索建议，最后一个单词作为前缀
+//       1102 --bench [phrases] [queries]
+auto main(const int argc, char *argv[]) -> int {
+    if (ez::bench::requested(argc, argv)) {
+        ez::bench::Runner runner{argc, argv, {.warmup = 1, .runs = 3}};
+        bench(runner);
+        return 0;
+    }
+
+    const string_view cmd{argc > 1 ? argv[1] : ""};
+    if (cmd == "build" && argc == 4) {
+        std::ifstream in{argv[2]};
+        if (!in) {
+            cout << format("cannot open {}\n", argv[2]);
+            return 1;
+        }
+        ez::TrieBuilder b{};
+        vector<string_view> words{};
+        for (string line{}; std::getline(in, line);) {
+            ez::split_words(line, words);
+            if (!words.empty()) { b.insert(words); }
+        }
+        const auto t{b.freeze()};
+        if (!t.save(argv[3])) {
+            cout << format("cannot write {}\n", argv[3]);
+            return 1;
+        }
+        cout << format("{} phrases, {} nodes, {} words, {} bytes\n", b.phrases(), t.size(), t.words(), t.bytes());
+        return 0;
+    }
+    if (cmd == "suggest" && argc >= 3) {
+        const auto t{ez::CompactTrie::open(argv[2])};
+        if (!t) {
+            cout << format("{} is not a trie file\n", argv[2]);
+            return 1;
+        }
+        string query{};
+        for (int i{3}; i < argc; ++i) { query += format("{}{}", i > 3 ? " " : "", argv[i]); }
+        print_suggestions(*t, query);
+        return 0;
+    }
+
+    bw::trie ts;
+    ts.insert({"all", "along", "the", "watchtower"});
+    ts.insert({"all", "you", "need", "is", "love"});
+    ts.insert({"all", "shook", "up"});
+    ts.insert({"all", "the", "best"});
+    ts.insert({"all", "the", "gold", "in", "california"});
+    ts.insert({"at", "last"});
+    ts.insert({"love", "the", "one", "you're", "with"});
+    ts.insert({"love", "me", "do"});
+    ts.insert({"love", "is", "the", "answer"});
+    ts.insert({"loving", "you"});
+    ts.insert({"long", "tall", "sally"});
+
+    {
+        const auto prefix = {"love"};
+        if (auto st{ts.search(prefix)}) { print_trie_prefix(**st, prefix); }
+        cout << '\n';
+    }
+    {
+        const auto prefix = {"all", "the"};
+        if (auto st{ts.search(prefix)}) { print_trie_prefix(**st, prefix); }
+        cout << '\n';
+    }
+    {
+        const char *prefix{"lo"};
+        auto prefix_dq{ts.find_prefix(prefix)};
+        for (const auto &s : prefix_dq) {
+            cout << format("match: {} -> {}\n", prefix, s);
+            if (auto st{ts.search(s)}) { print_trie_prefix(**st, s); }
+        }
+        cout << '\n';
+    }
+
+    // 同样的短语放进 CompactTrie，结果是指向字符池的 string_view
+    ez::TrieBuilder builder{};
+    builder.insert({"all", "along", "the", "watchtower"});
+    builder.insert({"all", "you", "need", "is", "love"});
+    builder.insert({"all", "shook", "up"});
+    builder.insert({"all", "the", "best"});
+    builder.insert({"all", "the", "gold", "in", "california"});
+    builder.insert({"at", "last"});
+    builder.insert({"love", "the", "one", "you're", "with"});
+    builder.insert({"love", "me", "do"});
+    builder.insert({"love", "is", "the", "answer"});
+    builder.insert({"loving", "you"});
+    builder.insert({"long", "tall", "sally"});
+    const auto trie{builder.freeze()};
+    cout << format("compact trie: {} nodes, {} words, {} bytes\n", trie.size(), trie.words(), trie.bytes());
+    print_suggestions(trie, "love ");
+    print_suggestions(trie, "all the ");
+    print_suggestions(trie, "lo");
+    print_suggestions(trie, "all the g");
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+
+// 替换全局 operator new / delete，统计堆分配次数和字节数
+// 替换函数不能是 inline，所以每个程序只能在一个翻译单元中包含本头文件
+namespace ez::alloc {
+    inline std::atomic<size_t> count{};
+    inline std::atomic<size_t> bytes{};
+
+    // 从构造到调用 allocations() 之间发生的分配次数
+    class Scope {
+        size_t count0_{count.load(std::memory_order_relaxed)};
+        size_t bytes0_{bytes.load(std::memory_order_relaxed)};
+
+      public:
+        [[nodiscard]] auto allocations() const -> size_t { return count.load(std::memory_order_relaxed) - count0_; }
+        [[nodiscard]] auto allocated_bytes() const -> size_t { return bytes.load(std::memory_order_relaxed) - bytes0_; }
+    };
+} // namespace ez::alloc
+
+auto operator new(std::size_t n) -> void * {
+    ez::alloc::count.fetch_add(1, std::memory_order_relaxed);
+    ez::alloc::bytes.fetch_add(n, std::memory_order_relaxed);
+    if (void *p{std::malloc(n == 0 ? 1 : n)}; p != nullptr) { return p; }
+    throw std::bad_alloc{};
+}
+
+auto operator new[](std::size_t n) -> void * { return ::operator new(n); }
+
+void operator delete(void *p) noexcept { std::free(p); }
+void operator delete[](void *p) noexcept { std::free(p); }
+void operator delete(void *p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void *p, std::size_t) noexcept { std::free(p); }
@@ -0,0 +1,19 @@
+#pragma once
+
+#include <charconv>
+#include <cstddef>
+#include <optional>
+#include <string_view>
+#include <system_error>
+
+// 命令行参数解析
+namespace ez {
+    // 十进制无符号整数，必须整个字符串都是数字且在 [lo, hi] 内，否则返回空
+    // 与 std::stoul 不同：非数字不会抛出异常，"-1" 也不会回绕成很大的数
+    inline auto parse_size(std::string_view s, size_t lo, size_t hi) -> std::optional<size_t> {
+        size_t v{};
+        const auto [end, ec]{std::from_chars(s.data(), s.data() + s.size(), v)};
+        if (ec != std::errc{} || end != s.data() + s.size() || v < lo || v > hi) { return std::nullopt; }
+        return v;
+    }
+} // namespace ez
@@ -0,0 +1,172 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <format>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+// 基准测试：预热、重复运行、统计 min/median/p99，并可输出 JSON 以便跨编译器追踪回归
+// 参数：--bench 开启测试；--json[=file] 输出 JSON（默认 stdout）；--runs=N；--warmup=N
+// 定义 EZ_BENCH 时（xmake 的 bench_* 目标）不需要 --bench
+// 报告写到 stderr，stdout 只留给 JSON；测试代码中的校验和统计信息也应写到 stderr
+namespace ez::bench {
+    // 阻止编译器把只计算不使用的结果优化掉
+    template <typename T>
+    inline void do_not_optimize(T &&v) {
+#if defined(__GNUC__) || defined(__clang__)
+        asm volatile("" : : "g"(&v) : "memory");
+#else
+        static const void *volatile sink{}; // 指针本身是 volatile，每次写入都不能省略
+        sink = &v;
+        std::atomic_signal_fence(std::memory_order_seq_cst);
+#endif
+    }
+
+    inline auto requested(int argc, char *argv[]) -> bool {
+#ifdef EZ_BENCH
+        (void)argc;
+        (void)argv;
+        return true;
+#else
+        return std::any_of(argv + 1, argv + argc, [](const char *a) { return std::string_view{a} == "--bench"; });
+#endif
+    }
+
+    inline auto compiler() -> std::string {
+#if defined(__clang__)
+        return std::format("clang {}.{}.{}", __clang_major__, __clang_minor__, __clang_patchlevel__);
+#elif defined(_MSC_VER)
+        return std::format("msvc {}", _MSC_FULL_VER);
+#elif defined(__GNUC__)
+        return std::format("gcc {}.{}.{}", __GNUC__, __GNUC_MINOR__, __GNUC_PATCHLEVEL__);
+#else
+        return "unknown";
+#endif
+    }
+
+    struct Options {
+        size_t warmup{2};
+        size_t runs{15};
+    };
+
+    struct Result {
+        std::string name{};
+        size_t items{}; // 每次运行处理的元素个数
+        size_t runs{};
+        double min_ns{};
+        double median_ns{};
+        double p99_ns{};
+        double mean_ns{};
+
+        [[nodiscard]] auto items_per_sec() const -> double {
+            return median_ns > 0 ? static_cast<double>(items) * 1e9 / median_ns : 0.0;
+        }
+    };
+
+    class Runner {
+        Options opt_{};
+        std::vector<Result> results_{};
+        std::vector<std::string_view> args_{};
+        bool json_{};
+        std::string json_path_{};
+
+        static auto parse_count(std::string_view s) -> size_t {
+            size_t v{};
+            for (const char c : s) {
+                if (c < '0' || c > '9') { break; }
+                v = v * 10 + static_cast<size_t>(c - '0');
+            }
+            return v;
+        }
+
+        auto record(std::string_view name, size_t items, std::vector<double> &ns) -> const Result & {
+            std::ranges::sort(ns);
+            Result r{std::string{name}, items, ns.size()};
+            r.min_ns = ns.front();
+            r.median_ns = ns[ns.size() / 2];
+            r.p99_ns = ns[std::min(ns.size() - 1, ns.size() * 99 / 100)];
+            for (const double v : ns) { r.mean_ns += v / static_cast<double>(ns.size()); }
+            std::cerr << std::format("{:<36} median {:12.3f} ms  p99 {:12.3f} ms  {:14.0f} items/s\n", r.name,
+                                     r.median_ns / 1e6, r.p99_ns / 1e6, r.items_per_sec());
+            return results_.emplace_back(std::move(r));
+        }
+
+      public:
+        Runner(int argc, char *argv[], Options opt = {}) : opt_{opt} {
+            for (int i{1}; i < argc; ++i) {
+                const std::string_view a{argv[i]};
+                if (a == "--bench") { continue; }
+                if (a == "--json" || a.starts_with("--json=")) {
+                    json_ = true;
+                    json_path_ = a.size() > 7 ? a.substr(7) : "";
+                } else if (a.starts_with("--runs=")) {
+                    opt_.runs = std::max<size_t>(1, parse_count(a.substr(7)));
+                } else if (a.starts_with("--warmup=")) {
+                    opt_.warmup = parse_count(a.substr(9));
+                } else if (!a.starts_with("-")) {
+                    args_.push_back(a);
+                }
+            }
+        }
+
+        Runner(const Runner &) = delete;
+        auto operator=(const Runner &) -> Runner & = delete;
+        ~Runner() { write_json(); }
+
+        // 第 i 个非选项参数
+        [[nodiscard]] auto arg(size_t i, std::string_view def) const -> std::string_view {
+            return i < args_.size() ? args_[i] : def;
+        }
+
+        [[nodiscard]] auto count(size_t i, size_t def) const -> size_t {
+            return i < args_.size() ? parse_count(args_[i]) : def;
+        }
+
+        // 每次运行前调用 setup() 准备状态，只对 f(state) 计时
+        template <typename Setup, typename F>
+        auto run(std::string_view name, size_t items, Setup &&setup, F &&f) -> const Result & {
+            using clock = std::chrono::steady_clock;
+            std::vector<double> ns{};
+            for (size_t i{}; i < opt_.warmup + opt_.runs; ++i) {
+                auto state{setup()};
+                const auto t0{clock::now()};
+                do_not_optimize(f(state));
+                const auto t1{clock::now()};
+                if (i >= opt_.warmup) { ns.push_back(std::chrono::duration<double, std::nano>(t1 - t0).count()); }
+            }
+            return record(name, items, ns);
+        }
+
+        template <typename F>
+        auto run(std::string_view name, size_t items, F &&f) -> const Result & {
+            return run(name, items, [] { return 0; }, [&f](int) { return f(); });
+        }
+
+        void write_json() {
+            if (!json_ || results_.empty()) { return; }
+            std::string s{std::format("{{\n  \"context\": {{\"compiler\": \"{}\", \"cplusplus\": {}}},\n  \"benchmarks\": [\n",
+                                      compiler(), __cplusplus)};
+            for (size_t i{}; i < results_.size(); ++i) {
+                const auto &r{results_[i]};
+                s += std::format("    {{\"name\": \"{}\", \"items\": {}, \"runs\": {}, \"min_ns\": {:.1f}, \"median_ns\": {:.1f}, "
+                                 "\"p99_ns\": {:.1f}, \"mean_ns\": {:.1f}, \"items_per_second\": {:.1f}}}{}\n",
+                                 r.name, r.items, r.runs, r.min_ns, r.median_ns, r.p99_ns, r.mean_ns, r.items_per_sec(),
+                                 i + 1 < results_.size() ? "," : "");
+            }
+            s += "  ]\n}\n";
+
+            std::FILE *f{json_path_.empty() ? stdout : std::fopen(json_path_.c_str(), "w")};
+            if (f == nullptr) { return; }
+            std::fwrite(s.data(), 1, s.size(), f);
+            if (f != stdout) { std::fclose(f); }
+            results_.clear();
+        }
+    };
+} // namespace ez::bench
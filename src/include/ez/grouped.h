@@ -0,0 +1,58 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <format>
+#include <string>
+
+// 数字按千位分组："{}" 输出 1,234,567，"{:_}" 等使用指定的分隔符
+// 从低位向高位一次写完，不像反复 insert 那样是 O(n^2)
+namespace ez {
+    // uint64_t 最多 20 位数字和 6 个分隔符
+    constexpr size_t max_grouped{26};
+
+    // 从 end 向前逐位写入数字，每 3 位插入一个分隔符，返回起始位置
+    constexpr auto group_digits(char *end, uint64_t num, char sep = ',') -> char * {
+        char *p{end};
+        for (int n{};; ++n) {
+            if (n != 0 && n % 3 == 0) { *--p = sep; }
+            *--p = static_cast<char>('0' + num % 10);
+            num /= 10;
+            if (num == 0) { return p; }
+        }
+    }
+
+    template <typename Out>
+    auto format_grouped_to(Out out, uint64_t num, char sep = ',') -> Out {
+        char buf[max_grouped];
+        char *end{buf + max_grouped};
+        return std::copy(group_digits(end, num, sep), end, out);
+    }
+
+    inline auto to_grouped(uint64_t num, char sep = ',') -> std::string {
+        char buf[max_grouped];
+        char *end{buf + max_grouped};
+        return {group_digits(end, num, sep), end};
+    }
+
+    // 用于 format 的包装类型
+    struct grouped {
+        uint64_t value;
+    };
+} // namespace ez
+
+template <>
+struct std::formatter<ez::grouped> {
+    char sep_{','};
+
+    constexpr auto parse(std::format_parse_context &ctx) {
+        auto it{ctx.begin()};
+        if (it != ctx.end() && *it != '}') { sep_ = *it++; }
+        return it;
+    }
+
+    auto format(const ez::grouped &g, std::format_context &ctx) const {
+        return ez::format_grouped_to(ctx.out(), g.value, sep_);
+    }
+};
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <cstddef>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <string_view>
+
+#if defined(__unix__) || defined(__APPLE__)
+#    include <fcntl.h>
+#    include <sys/mman.h>
+#    include <sys/stat.h>
+#    include <unistd.h>
+#    define EZ_MMAP 1
+#endif
+
+namespace ez {
+    namespace fs = std::filesystem;
+
+    // 只读访问整个文件：较大的文件使用 mmap，小文件直接读入（映射和解除映射的系统调用比一次 read 更贵）
+    // 不支持 mmap 的平台全部读入内存；打开失败或空文件时 data() 为空
+    class MappedFile {
+        std::string_view data_{};
+        std::string buf_{};
+#ifdef EZ_MMAP
+        void *addr_{};
+#endif
+
+      public:
+        static constexpr size_t mmap_threshold{64 * 1024};
+
+        explicit MappedFile(const fs::path &p) {
+#ifdef EZ_MMAP
+            const int fd{::open(p.c_str(), O_RDONLY)};
+            if (fd < 0) { return; }
+            struct stat st {};
+            if (::fstat(fd, &st) == 0 && st.st_size > 0) {
+                const auto size{static_cast<size_t>(st.st_size)};
+                if (size >= mmap_threshold) {
+                    if (void *a{::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0)}; a != MAP_FAILED) {
+                        addr_ = a;
+                        data_ = {static_cast<const char *>(a), size};
+                    }
+                } else {
+                    buf_.resize(size);
+                    size_t got{};
+                    for (ssize_t n{}; got < size && (n = ::read(fd, buf_.data() + got, size - got)) > 0;) {
+                        got += static_cast<size_t>(n);
+                    }
+                    buf_.resize(got);
+                    data_ = buf_;
+                }
+            }
+            ::close(fd);
+#else
+            std::ifstream in{p, std::ios::binary};
+            buf_.assign(std::istreambuf_iterator<char>{in}, std::istreambuf_iterator<char>{});
+            data_ = buf_;
+#endif
+        }
+
+        MappedFile(const MappedFile &) = delete;
+        auto operator=(const MappedFile &) -> MappedFile & = delete;
+
+        ~MappedFile() {
+#ifdef EZ_MMAP
+            if (addr_ != nullptr) { ::munmap(addr_, data_.size()); }
+#endif
+        }
+
+        [[nodiscard]] auto data() const -> std::string_view { return data_; }
+    };
+} // namespace ez
@@ -0,0 +1,120 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <concepts>
+#include <cstddef>
+#include <cstdio>
+#include <format>
+#include <iterator>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+namespace ez {
+    // 可作为模板实参的字符串字面量
+    template <size_t N>
+    struct fixed_string {
+        char data[N]{};
+
+        constexpr fixed_string(const char (&s)[N]) { std::copy_n(s, N, data); }
+        [[nodiscard]] constexpr auto view() const -> std::string_view { return {data, N - 1}; }
+    };
+
+    // 格式串只由字面文本和不带格式说明的 "{}" 组成时，返回被 "{}" 分隔的 args + 1 段文本
+    template <fixed_string F, size_t Args>
+    constexpr auto plain_segments() -> std::optional<std::array<std::string_view, Args + 1>> {
+        constexpr std::string_view f{F.view()};
+        std::array<std::string_view, Args + 1> segs{};
+        size_t k{};
+        size_t begin{};
+        for (size_t i{}; i < f.size(); ++i) {
+            if (f[i] == '}') { return std::nullopt; } // 单独的 } 或 }}
+            if (f[i] != '{') { continue; }
+            if (i + 1 >= f.size() || f[i + 1] != '}' || k == Args) { return std::nullopt; }
+            segs[k++] = f.substr(begin, i - begin);
+            begin = ++i + 1;
+        }
+        if (k != Args) { return std::nullopt; }
+        segs[k] = f.substr(begin);
+        return segs;
+    }
+
+    // 格式化输出缓冲：std::format_to 直接写入可增长的缓冲区，攒够 flush_size 字节后一次写出
+    // 与 cout 混用时，切换回 cout 之前必须先 flush()
+    class OutBuf {
+        std::string buf_{};
+        std::FILE *file_{};
+
+      public:
+        static constexpr size_t flush_size{1 << 16};
+
+        explicit OutBuf(std::FILE *file = stdout) : file_{file} { buf_.reserve(flush_size * 2); }
+        OutBuf(const OutBuf &) = delete;
+        auto operator=(const OutBuf &) -> OutBuf & = delete;
+        ~OutBuf() { flush(); }
+
+        template <typename... Args>
+        void print(std::format_string<Args...> fmt, Args &&...args) {
+            std::format_to(std::back_inserter(buf_), fmt, std::forward<Args>(args)...);
+            if (buf_.size() >= flush_size) { flush(); }
+        }
+
+        // 先格式化到大小为 N 的栈上缓冲，超出部分被截断，不会分配内存
+        template <size_t N = 256, typename... Args>
+        void print_n(std::format_string<Args...> fmt, Args &&...args) {
+            char tmp[N];
+            const auto r{std::format_to_n(tmp, N, fmt, std::forward<Args>(args)...)};
+            write({tmp, std::min(static_cast<size_t>(r.size), N)});
+        }
+
+        // 编译期确定格式串：全部占位符都是 "{}" 时（如 "{} "、"{}:{}\n"）不经过 std::format，
+        // 按实参类型直接写入：整数和浮点数用 to_chars，字符串直接复制；其余格式串退回 std::format
+        template <fixed_string F, typename... Args>
+        void put(const Args &...args) {
+            if constexpr (constexpr auto segs{plain_segments<F, sizeof...(Args)>()}; segs.has_value()) {
+                size_t k{};
+                ((buf_.append((*segs)[k++]), append(args)), ...);
+                buf_.append(segs->back());
+            } else {
+                std::format_to(std::back_inserter(buf_), std::format_string<const Args &...>{F.view()}, args...);
+            }
+            if (buf_.size() >= flush_size) { flush(); }
+        }
+
+        // 与 std::format("{}", v) 的输出相同
+        template <typename T>
+        void append(const T &v) {
+            if constexpr ((std::integral<T> && !std::same_as<T, bool> && !std::same_as<T, char>) || std::same_as<T, float> ||
+                          std::same_as<T, double>) {
+                char tmp[32];
+                const auto r{std::to_chars(tmp, tmp + sizeof(tmp), v)};
+                buf_.append(tmp, r.ptr);
+            } else if constexpr (std::is_convertible_v<const T &, std::string_view>) {
+                buf_.append(std::string_view{v});
+            } else {
+                std::format_to(std::back_inserter(buf_), "{}", v);
+            }
+        }
+
+        void write(std::string_view s) {
+            buf_.append(s);
+            if (buf_.size() >= flush_size) { flush(); }
+        }
+
+        void flush() {
+            if (buf_.empty()) { return; }
+            std::fwrite(buf_.data(), 1, buf_.size(), file_);
+            buf_.clear();
+        }
+    };
+
+    // 每个线程一个 stdout 缓冲，线程结束时自动 flush
+    inline auto out() -> OutBuf & {
+        thread_local OutBuf o{stdout};
+        return o;
+    }
+} // namespace ez
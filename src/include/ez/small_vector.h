@@ -0,0 +1,187 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <concepts>
+#include <cstddef>
+#include <initializer_list>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+// 元素存放在对象内部的 vector，可以在常量求值中构造，并作为 constexpr 变量保留到运行期
+// std::vector 做不到这一点：常量求值中分配的堆内存不能延续到运行期
+// 为了在 constexpr 中可用，内部存储是 std::array，所以 T 需要可默认构造
+namespace ez {
+    // 容量固定为 N，超出时抛出 std::length_error，从不分配堆内存
+    template <std::default_initializable T, size_t N>
+    class static_vector {
+        std::array<T, N> data_{};
+        size_t size_{};
+
+      public:
+        using value_type = T;
+        using iterator = T *;
+        using const_iterator = const T *;
+
+        constexpr static_vector() = default;
+        constexpr static_vector(std::initializer_list<T> init) {
+            for (const auto &e : init) { push_back(e); }
+        }
+
+        [[nodiscard]] constexpr auto size() const -> size_t { return size_; }
+        [[nodiscard]] static constexpr auto capacity() -> size_t { return N; }
+        [[nodiscard]] constexpr auto empty() const -> bool { return size_ == 0; }
+
+        [[nodiscard]] constexpr auto data() -> T * { return data_.data(); }
+        [[nodiscard]] constexpr auto data() const -> const T * { return data_.data(); }
+        [[nodiscard]] constexpr auto begin() -> iterator { return data(); }
+        [[nodiscard]] constexpr auto end() -> iterator { return data() + size_; }
+        [[nodiscard]] constexpr auto begin() const -> const_iterator { return data(); }
+        [[nodiscard]] constexpr auto end() const -> const_iterator { return data() + size_; }
+
+        constexpr auto operator[](size_t i) -> T & { return data_[i]; }
+        constexpr auto operator[](size_t i) const -> const T & { return data_[i]; }
+        constexpr auto front() -> T & { return data_[0]; }
+        constexpr auto back() -> T & { return data_[size_ - 1]; }
+        [[nodiscard]] constexpr auto front() const -> const T & { return data_[0]; }
+        [[nodiscard]] constexpr auto back() const -> const T & { return data_[size_ - 1]; }
+
+        template <typename... Args>
+        constexpr auto emplace_back(Args &&...args) -> T & {
+            if (size_ == N) { throw std::length_error("static_vector is full"); }
+            data_[size_] = T(std::forward<Args>(args)...);
+            return data_[size_++];
+        }
+        constexpr void push_back(const T &v) { emplace_back(v); }
+        constexpr void push_back(T &&v) { emplace_back(std::move(v)); }
+
+        // 被移除的元素重置为 T{}，及时释放它持有的资源
+        constexpr void pop_back() { data_[--size_] = T{}; }
+        constexpr void clear() {
+            while (size_ != 0) { pop_back(); }
+        }
+
+        friend constexpr auto operator==(const static_vector &a, const static_vector &b) -> bool {
+            return std::equal(a.begin(), a.end(), b.begin(), b.end());
+        }
+    };
+
+    // 前 N 个元素存放在对象内部，超过 N 时把全部元素移到堆上的 std::vector
+    // 常量求值中同样可以溢出到堆，只要结果不溢出就能作为 constexpr 变量保留
+    template <std::default_initializable T, size_t N>
+    class small_vector {
+        std::array<T, N> inline_{};
+        std::vector<T> heap_{}; // 溢出后保存全部元素
+        size_t size_{};
+        bool spilled_{};
+
+        [[nodiscard]] constexpr auto spilled() const -> bool { return spilled_; }
+
+        constexpr void spill(size_t capacity) {
+            heap_.reserve(std::max(capacity, N * 2));
+            for (size_t i{}; i < size_; ++i) { heap_.push_back(std::exchange(inline_[i], T{})); }
+            spilled_ = true;
+        }
+
+      public:
+        using value_type = T;
+        using iterator = T *;
+        using const_iterator = const T *;
+
+        constexpr small_vector() = default;
+        constexpr small_vector(std::initializer_list<T> init) {
+            reserve(init.size());
+            for (const auto &e : init) { push_back(e); }
+        }
+        constexpr small_vector(const small_vector &) = default;
+        constexpr auto operator=(const small_vector &) -> small_vector & = default;
+
+        // 移动后源对象为空并回到内部存储；默认的移动只移走 heap_，源对象的 size_ 和 spilled_ 会指向空的堆数组
+        constexpr small_vector(small_vector &&o) noexcept
+            : inline_{std::move(o.inline_)}, heap_{std::move(o.heap_)}, size_{std::exchange(o.size_, 0)},
+              spilled_{std::exchange(o.spilled_, false)} {}
+
+        constexpr auto operator=(small_vector &&o) noexcept -> small_vector & {
+            if (this != &o) {
+                inline_ = std::move(o.inline_);
+                heap_ = std::move(o.heap_);
+                o.heap_.clear();
+                size_ = std::exchange(o.size_, 0);
+                spilled_ = std::exchange(o.spilled_, false);
+            }
+            return *this;
+        }
+
+        [[nodiscard]] constexpr auto size() const -> size_t { return size_; }
+        [[nodiscard]] constexpr auto capacity() const -> size_t { return spilled() ? heap_.capacity() : N; }
+        [[nodiscard]] constexpr auto empty() const -> bool { return size_ == 0; }
+        // 元素仍在对象内部，没有使用堆内存
+        [[nodiscard]] constexpr auto is_inline() const -> bool { return !spilled(); }
+
+        [[nodiscard]] constexpr auto data() -> T * { return spilled() ? heap_.data() : inline_.data(); }
+        [[nodiscard]] constexpr auto data() const -> const T * { return spilled() ? heap_.data() : inline_.data(); }
+        [[nodiscard]] constexpr auto begin() -> iterator { return data(); }
+        [[nodiscard]] constexpr auto end() -> iterator { return data() + size_; }
+        [[nodiscard]] constexpr auto begin() const -> const_iterator { return data(); }
+        [[nodiscard]] constexpr auto end() const -> const_iterator { return data() + size_; }
+
+        constexpr auto operator[](size_t i) -> T & { return data()[i]; }
+        constexpr auto operator[](size_t i) const -> const T & { return data()[i]; }
+        constexpr auto front() -> T & { return data()[0]; }
+        constexpr auto back() -> T & { return data()[size_ - 1]; }
+        [[nodiscard]] constexpr auto front() const -> const T & { return data()[0]; }
+        [[nodiscard]] constexpr auto back() const -> const T & { return data()[size_ - 1]; }
+
+        constexpr void reserve(size_t n) {
+            if (spilled()) {
+                heap_.reserve(n);
+            } else if (n > N) {
+                spill(n);
+            }
+        }
+
+        template <typename... Args>
+        constexpr auto emplace_back(Args &&...args) -> T & {
+            if (spilled()) {
+                ++size_;
+                return heap_.emplace_back(std::forward<Args>(args)...);
+            }
+            if (size_ == N) {
+                // args 可能引用内部的元素，spill() 会把它们移走，所以先构造新元素
+                T v(std::forward<Args>(args)...);
+                spill(N * 2);
+                ++size_;
+                return heap_.emplace_back(std::move(v));
+            }
+            inline_[size_] = T(std::forward<Args>(args)...);
+            return inline_[size_++];
+        }
+        constexpr void push_back(const T &v) { emplace_back(v); }
+        constexpr void push_back(T &&v) { emplace_back(std::move(v)); }
+
+        constexpr void pop_back() {
+            if (spilled()) {
+                heap_.pop_back();
+            } else {
+                inline_[size_ - 1] = T{};
+            }
+            --size_;
+        }
+
+        // 清空后释放堆内存，回到内部存储
+        constexpr void clear() {
+            if (spilled()) {
+                heap_ = {};
+                spilled_ = false;
+            } else {
+                std::fill_n(inline_.begin(), size_, T{});
+            }
+            size_ = 0;
+        }
+
+        friend constexpr auto operator==(const small_vector &a, const small_vector &b) -> bool {
+            return std::equal(a.begin(), a.end(), b.begin(), b.end());
+        }
+    };
+} // namespace ez
@@ -0,0 +1,247 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <ranges>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "ez/thread_pool.h"
+
+// 并行排序和基数排序，参数形式同 std::ranges 算法，返回 end
+//   par_sort(r, comp, proj)   并行归并排序，稳定，基于工作窃取的 TaskPool；归并缓冲要求元素可默认构造
+//   radix_sort(r, proj)       LSD 基数排序，投影得到整数或浮点数键，按键升序，稳定；元素需可默认构造
+//   string_sort(r, proj)      多键快速排序（三路基数快排），投影结果可转换为 string_view，结果与按字节比较的 < 相同
+namespace ez {
+    namespace detail {
+        constexpr size_t sort_cutoff{1 << 14}; // 小于此长度时串行排序
+
+        // 将 [a, a_end) 和 [b, b_end) 归并到 out；元素较多时在较长一段取中点，
+        // 在另一段二分查找切分点，两半分别并行归并
+        template <typename It, typename Out, typename Comp>
+        void par_merge(It a, It a_end, It b, It b_end, Out out, Comp &comp, TaskGroup *group) {
+            const auto na{a_end - a};
+            const auto nb{b_end - b};
+            if (na + nb <= static_cast<std::ptrdiff_t>(sort_cutoff) || group == nullptr) {
+                std::merge(std::make_move_iterator(a), std::make_move_iterator(a_end), std::make_move_iterator(b),
+                           std::make_move_iterator(b_end), out, std::ref(comp));
+                return;
+            }
+            if (na >= nb) {
+                const It am{a + na / 2};
+                const It bm{std::lower_bound(b, b_end, *am, std::ref(comp))};
+                const Out om{out + (am - a) + (bm - b)};
+                group->run([=, &comp] { par_merge(a, am, b, bm, out, comp, group); });
+                par_merge(am, a_end, bm, b_end, om, comp, group);
+            } else {
+                const It bm{b + nb / 2};
+                const It am{std::upper_bound(a, a_end, *bm, std::ref(comp))};
+                const Out om{out + (am - a) + (bm - b)};
+                group->run([=, &comp] { par_merge(a, am, b, bm, out, comp, group); });
+                par_merge(am, a_end, bm, b_end, om, comp, group);
+            }
+        }
+
+        // 排序 [first, last)，buf 为等长的临时空间
+        template <typename It, typename BufIt, typename Comp>
+        void par_merge_sort(It first, It last, BufIt buf, Comp &comp) {
+            const auto n{last - first};
+            if (n <= static_cast<std::ptrdiff_t>(sort_cutoff)) {
+                std::stable_sort(first, last, std::ref(comp));
+                return;
+            }
+            const It mid{first + n / 2};
+            {
+                TaskGroup group{};
+                group.run([&] { par_merge_sort(first, mid, buf, comp); });
+                par_merge_sort(mid, last, buf + (mid - first), comp);
+                group.wait();
+            }
+            {
+                TaskGroup group{};
+                par_merge(first, mid, mid, last, buf, comp, &group);
+                group.wait();
+            }
+            {
+                TaskGroup group{};
+                for (std::ptrdiff_t i{}; i < n; i += static_cast<std::ptrdiff_t>(sort_cutoff)) {
+                    const auto len{std::min(n - i, static_cast<std::ptrdiff_t>(sort_cutoff))};
+                    group.run([=] { std::move(buf + i, buf + i + len, first + i); });
+                }
+                group.wait();
+            }
+        }
+
+        // radix_sort 支持的键类型
+        template <typename K>
+        concept radix_sortable = std::integral<K> || std::same_as<K, float> || std::same_as<K, double>;
+
+        // 把键映射为无符号整数，使无符号比较的顺序与键本身的顺序相同
+        template <typename K>
+        constexpr auto radix_key(K k) {
+            if constexpr (std::same_as<K, bool>) {
+                return static_cast<uint8_t>(k);
+            } else if constexpr (std::unsigned_integral<K>) {
+                return k;
+            } else if constexpr (std::signed_integral<K>) {
+                using U = std::make_unsigned_t<K>;
+                return static_cast<U>(static_cast<U>(k) ^ (U{1} << (sizeof(K) * 8 - 1)));
+            } else {
+                static_assert(std::same_as<K, float> || std::same_as<K, double>, "radix_sort: unsupported key type");
+                using U = std::conditional_t<sizeof(K) == 4, uint32_t, uint64_t>;
+                const U u{std::bit_cast<U>(k)};
+                constexpr U sign{U{1} << (sizeof(K) * 8 - 1)};
+                return (u & sign) != 0 ? static_cast<U>(~u) : static_cast<U>(u | sign); // 负数全部取反
+            }
+        }
+
+        template <typename T, typename Proj>
+        auto string_key(const T &v, Proj &proj) -> std::string_view {
+            return std::string_view{std::invoke(proj, v)};
+        }
+
+        // 第 d 个字节，超出末尾时为 -1，使较短的字符串排在前面
+        inline auto byte_at(std::string_view s, size_t d) -> int {
+            return d < s.size() ? static_cast<unsigned char>(s[d]) : -1;
+        }
+
+        template <typename It, typename Proj>
+        void string_sort(It first, It last, size_t depth, Proj &proj, TaskGroup *group) {
+            while (last - first > 16) {
+                // 取首、中、尾三个元素在 depth 处字节的中位数作为枢轴
+                const auto n{last - first};
+                int pa{byte_at(string_key(*first, proj), depth)};
+                int pb{byte_at(string_key(first[n / 2], proj), depth)};
+                int pc{byte_at(string_key(first[n - 1], proj), depth)};
+                const int pivot{std::max(std::min(pa, pb), std::min(std::max(pa, pb), pc))};
+
+                // 三路划分：[first, lt) < pivot，[lt, gt) == pivot，[gt, last) > pivot
+                It lt{first};
+                It gt{last};
+                for (It i{first}; i < gt;) {
+                    const int c{byte_at(string_key(*i, proj), depth)};
+                    if (c < pivot) {
+                        std::iter_swap(lt++, i++);
+                    } else if (c > pivot) {
+                        std::iter_swap(i, --gt);
+                    } else {
+                        ++i;
+                    }
+                }
+
+                auto recurse = [&proj, group](It f, It l, size_t d) {
+                    if (group != nullptr && l - f > static_cast<std::ptrdiff_t>(sort_cutoff)) {
+                        group->run([f, l, d, &proj, group] { string_sort(f, l, d, proj, group); });
+                    } else {
+                        string_sort(f, l, d, proj, group);
+                    }
+                };
+                recurse(first, lt, depth);
+                recurse(gt, last, depth);
+                if (pivot < 0) { return; } // 等于枢轴的部分已经全部结束
+                first = lt;
+                last = gt;
+                ++depth;
+            }
+            // 短区间插入排序，前 depth 个字节已经相同
+            for (It i{first + (first != last)}; i < last; ++i) {
+                for (It j{i}; j > first && string_key(*j, proj).substr(depth) < string_key(*(j - 1), proj).substr(depth); --j) {
+                    std::iter_swap(j, j - 1);
+                }
+            }
+        }
+    } // namespace detail
+
+    template <std::ranges::random_access_range R, typename Comp = std::ranges::less, typename Proj = std::identity>
+        requires std::sortable<std::ranges::iterator_t<R>, Comp, Proj> && std::default_initializable<std::ranges::range_value_t<R>>
+    auto par_sort(R &&r, Comp comp = {}, Proj proj = {}) -> std::ranges::borrowed_iterator_t<R> {
+        const auto first{std::ranges::begin(r)};
+        const auto last{std::ranges::next(first, std::ranges::end(r))};
+        auto cmp = [&](const auto &a, const auto &b) -> bool {
+            return std::invoke(comp, std::invoke(proj, a), std::invoke(proj, b));
+        };
+        if (last - first <= static_cast<std::ptrdiff_t>(detail::sort_cutoff) || task_pool().size() == 1) {
+            std::stable_sort(first, last, cmp);
+            return last;
+        }
+        std::vector<std::iter_value_t<decltype(first)>> buf(static_cast<size_t>(last - first));
+        detail::par_merge_sort(first, last, buf.begin(), cmp);
+        return last;
+    }
+
+    template <std::ranges::random_access_range R, typename Proj = std::identity>
+        requires std::permutable<std::ranges::iterator_t<R>> && std::default_initializable<std::ranges::range_value_t<R>> &&
+                 detail::radix_sortable<std::remove_cvref_t<std::invoke_result_t<Proj &, std::ranges::range_reference_t<R>>>>
+    auto radix_sort(R &&r, Proj proj = {}) -> std::ranges::borrowed_iterator_t<R> {
+        using T = std::ranges::range_value_t<R>;
+        using K = decltype(detail::radix_key(std::invoke(proj, std::declval<const T &>())));
+        constexpr size_t passes{sizeof(K)};
+        const auto first{std::ranges::begin(r)};
+        const auto last{std::ranges::next(first, std::ranges::end(r))};
+        const auto n{static_cast<size_t>(last - first)};
+
+        // 一次遍历统计所有字节的直方图
+        std::vector<std::array<size_t, 256>> count(passes);
+        for (auto it{first}; it != last; ++it) {
+            const K k{detail::radix_key(std::invoke(proj, *it))};
+            for (size_t p{}; p < passes; ++p) { ++count[p][(k >> (p * 8)) & 0xff]; }
+        }
+
+        std::vector<T> buf(n);
+        auto src{first};
+        auto dst{buf.begin()};
+        bool in_buf{};
+        for (size_t p{}; p < passes; ++p) {
+            auto &c{count[p]};
+            if (std::ranges::find(c, n) != c.end()) { continue; } // 所有键在该字节上相同，跳过
+            size_t sum{};
+            for (auto &e : c) { sum += std::exchange(e, sum); }
+            auto scatter = [&](auto from, auto to) {
+                for (size_t i{}; i < n; ++i) {
+                    const K k{detail::radix_key(std::invoke(proj, from[i]))};
+                    to[c[(k >> (p * 8)) & 0xff]++] = std::move(from[i]);
+                }
+            };
+            in_buf ? scatter(dst, src) : scatter(src, dst);
+            in_buf = !in_buf;
+        }
+        if (in_buf) { std::ranges::move(buf, first); }
+        return last;
+    }
+
+    template <std::ranges::random_access_range R, typename Proj = std::identity>
+        requires std::permutable<std::ranges::iterator_t<R>> &&
+                 std::convertible_to<std::invoke_result_t<Proj &, std::ranges::range_reference_t<R>>, std::string_view>
+    auto string_sort(R &&r, Proj proj = {}) -> std::ranges::borrowed_iterator_t<R> {
+        const auto first{std::ranges::begin(r)};
+        const auto last{std::ranges::next(first, std::ranges::end(r))};
+        const auto n{static_cast<size_t>(last - first)};
+
+        // 交换 std::string 等元素代价较高：先排序 (key, 下标)，再按排列一次移动到位
+        using T = std::ranges::range_value_t<R>;
+        std::vector<std::pair<std::string_view, size_t>> keys(n);
+        for (size_t i{}; i < n; ++i) { keys[i] = {detail::string_key(first[i], proj), i}; }
+        auto key_of = [](const std::pair<std::string_view, size_t> &k) { return k.first; };
+        if (task_pool().size() == 1) {
+            detail::string_sort(keys.begin(), keys.end(), 0, key_of, nullptr);
+        } else {
+            TaskGroup group{};
+            detail::string_sort(keys.begin(), keys.end(), 0, key_of, &group);
+            group.wait();
+        }
+
+        std::vector<T> sorted{};
+        sorted.reserve(n);
+        for (const auto &k : keys) { sorted.push_back(std::move(first[k.second])); }
+        std::ranges::move(sorted, first);
+        return last;
+    }
+} // namespace ez
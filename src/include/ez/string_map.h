@@ -0,0 +1,26 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <map>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+// 以 std::string 为键、支持异构查找的容器
+// 比较器和哈希带有 is_transparent 时，find / count / contains / equal_range 可以直接接受 string_view 或 const char*，
+// 不再为每次查找构造临时的 std::string
+namespace ez {
+    // 与 std::hash<std::string> 结果相同，string、string_view 和 const char* 都按 string_view 计算
+    struct string_hash {
+        using is_transparent = void;
+
+        auto operator()(std::string_view s) const noexcept -> size_t { return std::hash<std::string_view>{}(s); }
+    };
+
+    template <typename V>
+    using string_map = std::map<std::string, V, std::less<>>;
+
+    template <typename V>
+    using unordered_string_map = std::unordered_map<std::string, V, string_hash, std::equal_to<>>;
+} // namespace ez
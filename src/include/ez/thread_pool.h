@@ -0,0 +1,264 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace ez {
+    // 固定数量的工作线程，parallel_for 时调用者也参与执行，共 size() 个线程
+    // 任务按下标从原子计数器中动态领取，先完成的线程继续领取，负载自动均衡
+    class ThreadPool {
+        std::vector<std::jthread> workers_{};
+        std::mutex run_mtx_{}; // 同一时间只执行一个 parallel_for
+        std::mutex mtx_{};
+        std::condition_variable start_cv_{};
+        std::condition_variable done_cv_{};
+        std::function<void(size_t)> job_{};
+        size_t generation_{};
+        size_t active_{};
+        bool stop_{};
+
+        static auto in_pool() -> bool & {
+            thread_local bool flag{};
+            return flag;
+        }
+
+        void worker_loop(size_t index) {
+            in_pool() = true;
+            size_t seen{};
+            while (true) {
+                std::function<void(size_t)> *job{};
+                {
+                    std::unique_lock lock{mtx_};
+                    start_cv_.wait(lock, [&] { return stop_ || generation_ != seen; });
+                    if (stop_) { return; }
+                    seen = generation_;
+                    job = &job_;
+                }
+                (*job)(index);
+                const std::scoped_lock lock{mtx_};
+                if (--active_ == 0) { done_cv_.notify_one(); }
+            }
+        }
+
+      public:
+        explicit ThreadPool(size_t threads = std::max(1U, std::thread::hardware_concurrency())) {
+            for (size_t i{1}; i < threads; ++i) {
+                workers_.emplace_back([this, i] { worker_loop(i); });
+            }
+        }
+
+        ThreadPool(const ThreadPool &) = delete;
+        auto operator=(const ThreadPool &) -> ThreadPool & = delete;
+
+        ~ThreadPool() {
+            {
+                const std::scoped_lock lock{mtx_};
+                stop_ = true;
+            }
+            start_cv_.notify_all();
+            // workers_ 是第一个成员，最后才析构；在互斥量和条件变量析构之前显式等待线程退出
+            for (auto &w : workers_) { w.join(); }
+        }
+
+        [[nodiscard]] auto size() const -> size_t { return workers_.size() + 1; }
+
+        // 在全部线程上执行 f(task, thread)，task 取 [0, tasks)，thread 取 [0, size())
+        // 在任务内部再次调用时直接在当前线程串行执行，避免死锁；任务抛出的第一个异常在返回前重新抛出
+        template <typename F>
+        void parallel_for(size_t tasks, F &&f) {
+            if (tasks == 0) { return; }
+            if (in_pool() || workers_.empty() || tasks == 1) {
+                for (size_t t{}; t < tasks; ++t) { f(t, size_t{0}); }
+                return;
+            }
+
+            const std::scoped_lock run{run_mtx_};
+            std::atomic<size_t> next{};
+            std::exception_ptr error{};
+            std::mutex error_mtx{};
+            auto body = [&](size_t thread) {
+                try {
+                    for (size_t t{}; (t = next.fetch_add(1, std::memory_order_relaxed)) < tasks;) { f(t, thread); }
+                } catch (...) {
+                    next.store(tasks, std::memory_order_relaxed); // 其余任务不再执行
+                    const std::scoped_lock lock{error_mtx};
+                    if (!error) { error = std::current_exception(); }
+                }
+            };
+            {
+                const std::scoped_lock lock{mtx_};
+                job_ = body;
+                active_ = workers_.size();
+                ++generation_;
+            }
+            start_cv_.notify_all();
+
+            in_pool() = true;
+            body(0);
+            in_pool() = false;
+
+            std::unique_lock lock{mtx_};
+            done_cv_.wait(lock, [&] { return active_ == 0; });
+            job_ = nullptr;
+            lock.unlock();
+            if (error) { std::rethrow_exception(error); }
+        }
+    };
+
+    // 进程内共享的线程池
+    inline auto pool() -> ThreadPool & {
+        static ThreadPool p{};
+        return p;
+    }
+
+    // 工作窃取线程池，用于递归的分治任务
+    // 每个线程有自己的双端队列：自己从尾部取（最近拆分出的小任务，缓存更热），空闲线程从其他队列头部窃取（较大的任务）
+    // 池外的线程提交到 0 号队列；等待任务组时当前线程也执行任务，所以任务内可以再拆分并等待
+    class TaskPool {
+        struct Queue {
+            std::mutex mtx{};
+            std::deque<std::function<void()>> tasks{};
+        };
+
+        std::vector<std::unique_ptr<Queue>> queues_{};
+        std::vector<std::jthread> workers_{};
+        std::atomic<size_t> pending_{};
+        std::mutex sleep_mtx_{};
+        std::condition_variable sleep_cv_{};
+        bool stop_{};
+
+        // 当前线程在本池中的队列下标，池外线程为 0
+        auto self() const -> size_t {
+            const auto &[owner, index]{local()};
+            return owner == this ? index : 0;
+        }
+
+        static auto local() -> std::pair<const TaskPool *, size_t> & {
+            thread_local std::pair<const TaskPool *, size_t> id{};
+            return id;
+        }
+
+        auto pop(size_t i, bool back) -> std::function<void()> {
+            auto &q{*queues_[i]};
+            const std::scoped_lock lock{q.mtx};
+            if (q.tasks.empty()) { return {}; }
+            std::function<void()> task{std::move(back ? q.tasks.back() : q.tasks.front())};
+            back ? q.tasks.pop_back() : q.tasks.pop_front();
+            pending_.fetch_sub(1, std::memory_order_relaxed);
+            return task;
+        }
+
+        void worker_loop(size_t index) {
+            local() = {this, index};
+            while (true) {
+                if (run_one()) { continue; }
+                std::unique_lock lock{sleep_mtx_};
+                sleep_cv_.wait(lock, [&] { return stop_ || pending_.load(std::memory_order_relaxed) != 0; });
+                if (stop_) { return; }
+            }
+        }
+
+      public:
+        explicit TaskPool(size_t threads = std::max(1U, std::thread::hardware_concurrency())) {
+            for (size_t i{}; i < threads; ++i) { queues_.push_back(std::make_unique<Queue>()); }
+            for (size_t i{1}; i < threads; ++i) {
+                workers_.emplace_back([this, i] { worker_loop(i); });
+            }
+        }
+
+        TaskPool(const TaskPool &) = delete;
+        auto operator=(const TaskPool &) -> TaskPool & = delete;
+
+        ~TaskPool() {
+            {
+                const std::scoped_lock lock{sleep_mtx_};
+                stop_ = true;
+            }
+            sleep_cv_.notify_all();
+            // workers_ 声明在互斥量和条件变量之前，必须在它们析构之前显式等待线程退出
+            for (auto &w : workers_) { w.join(); }
+        }
+
+        [[nodiscard]] auto size() const -> size_t { return queues_.size(); }
+
+        // 当前线程的下标，取值 [0, size())，可用于按线程汇总结果；池外线程为 0
+        [[nodiscard]] auto index() const -> size_t { return self(); }
+
+        void push(std::function<void()> task) {
+            auto &q{*queues_[self()]};
+            {
+                const std::scoped_lock lock{q.mtx};
+                q.tasks.push_back(std::move(task));
+            }
+            pending_.fetch_add(1, std::memory_order_relaxed);
+            { const std::scoped_lock lock{sleep_mtx_}; }
+            sleep_cv_.notify_one();
+        }
+
+        // 执行一个任务：先取自己队列的尾部，再依次窃取其他队列的头部；没有任务时返回 false
+        auto run_one() -> bool {
+            const size_t me{self()};
+            auto task{pop(me, true)};
+            for (size_t k{1}; !task && k < queues_.size(); ++k) {
+                task = pop((me + k) % queues_.size(), false);
+            }
+            if (!task) { return false; }
+            task();
+            return true;
+        }
+    };
+
+    inline auto task_pool() -> TaskPool & {
+        static TaskPool p{};
+        return p;
+    }
+
+    // 一组 fork-join 任务：run() 提交，wait() 一边执行池中的任务一边等待本组完成
+    class TaskGroup {
+        TaskPool &pool_;
+        std::atomic<size_t> left_{};
+        std::mutex error_mtx_{};
+        std::exception_ptr error_{};
+
+      public:
+        explicit TaskGroup(TaskPool &pool = task_pool()) : pool_{pool} {}
+        TaskGroup(const TaskGroup &) = delete;
+        auto operator=(const TaskGroup &) -> TaskGroup & = delete;
+        ~TaskGroup() {
+            while (left_.load(std::memory_order_acquire) != 0) {
+                if (!pool_.run_one()) { std::this_thread::yield(); }
+            }
+        }
+
+        template <typename F>
+        void run(F &&f) {
+            left_.fetch_add(1, std::memory_order_relaxed);
+            pool_.push([this, f = std::forward<F>(f)]() mutable {
+                try {
+                    f();
+                } catch (...) {
+                    const std::scoped_lock lock{error_mtx_};
+                    if (!error_) { error_ = std::current_exception(); }
+                }
+                left_.fetch_sub(1, std::memory_order_release);
+            });
+        }
+
+        void wait() {
+            while (left_.load(std::memory_order_acquire) != 0) {
+                if (!pool_.run_one()) { std::this_thread::yield(); }
+            }
+            if (error_) { std::rethrow_exception(std::exchange(error_, nullptr)); }
+        }
+    };
+} // namespace ez
@@ -0,0 +1,236 @@
+#pragma once
+
+// 热路径插桩：作用域计时与计数器，程序退出时输出统计表（stderr）和 Chrome trace JSON
+// 定义 EZ_TRACE 时启用，否则 EZ_TRACE_SCOPE / EZ_TRACE_COUNT 展开为空语句，不产生任何代码
+// JSON 写入环境变量 EZ_TRACE_FILE 指定的文件（默认 trace.json），可用 chrome://tracing 或 Perfetto 打开
+//
+//   EZ_TRACE_SCOPE("3.12/count");        // 到作用域结束为止计时
+//   EZ_TRACE_COUNT("3.10/insert", 1);    // 累加计数器
+#ifdef EZ_TRACE
+
+#    include <algorithm>
+#    include <array>
+#    include <atomic>
+#    include <chrono>
+#    include <cstdint>
+#    include <cstdio>
+#    include <cstdlib>
+#    include <format>
+#    include <memory>
+#    include <mutex>
+#    include <string>
+#    include <string_view>
+#    include <vector>
+
+namespace ez::trace {
+    using clock = std::chrono::steady_clock;
+
+    constexpr size_t max_ids{64};          // 作用域名和计数器名各自的上限，含最后的 (overflow) 项
+    constexpr size_t max_events{1 << 20};  // 每个线程保留的原始事件数，超出后只计入统计
+
+    struct Event {
+        uint32_t id{};
+        int64_t start_ns{};
+        int64_t dur_ns{};
+    };
+
+    struct ScopeStat {
+        uint64_t calls{};
+        int64_t total_ns{};
+        int64_t max_ns{};
+    };
+
+    // 每个线程一份，只有所属线程写入，所以计数器不需要加锁，也不需要原子的读-改-写
+    struct ThreadLog {
+        uint32_t tid{};
+        std::vector<Event> events{};
+        std::array<ScopeStat, max_ids> scopes{};
+        std::array<std::atomic<uint64_t>, max_ids> counters{};
+        uint64_t dropped{};
+    };
+
+    class Registry {
+        std::mutex mtx_{};
+        std::vector<std::string_view> scope_names_{};
+        std::vector<std::string_view> counter_names_{};
+        std::vector<std::string_view> merged_scopes_{};   // 超出上限、归入 (overflow) 的名字
+        std::vector<std::string_view> merged_counters_{};
+        std::vector<std::unique_ptr<ThreadLog>> logs_{}; // 线程结束后日志仍由这里持有
+        clock::time_point epoch_{clock::now()};
+
+        // 最后一项保留为 "(overflow)"：名字过多时，之后的名字都计入这一项，并记下被合并的名字，统计表中给出提示
+        static auto intern(std::vector<std::string_view> &names, std::vector<std::string_view> &merged, std::string_view name)
+            -> uint32_t {
+            const auto it{std::ranges::find(names, name)};
+            if (it != names.end()) { return static_cast<uint32_t>(it - names.begin()); }
+            if (names.size() < max_ids - 1) {
+                names.push_back(name);
+                return static_cast<uint32_t>(names.size() - 1);
+            }
+            if (names.size() == max_ids - 1) { names.push_back("(overflow)"); }
+            if (std::ranges::find(merged, name) == merged.end()) { merged.push_back(name); }
+            return max_ids - 1;
+        }
+
+        static void report_merged(std::string &s, std::string_view kind, const std::vector<std::string_view> &merged) {
+            if (merged.empty()) { return; }
+            s += std::format("{} {} names over the limit of {} merged into (overflow):", merged.size(), kind, max_ids - 1);
+            for (const auto name : merged) { s += std::format(" {}", name); }
+            s += '\n';
+        }
+
+        void dump_text() const {
+            std::string s{"---- trace ----\n"};
+            s += std::format("{:<32} {:>10} {:>12} {:>12} {:>12}\n", "scope", "calls", "total ms", "mean us", "max us");
+            for (size_t id{}; id < scope_names_.size(); ++id) {
+                ScopeStat sum{};
+                for (const auto &log : logs_) {
+                    const auto &st{log->scopes[id]};
+                    sum.calls += st.calls;
+                    sum.total_ns += st.total_ns;
+                    sum.max_ns = std::max(sum.max_ns, st.max_ns);
+                }
+                s += std::format("{:<32} {:>10} {:>12.3f} {:>12.3f} {:>12.3f}\n", scope_names_[id], sum.calls,
+                                 static_cast<double>(sum.total_ns) / 1e6,
+                                 sum.calls == 0 ? 0.0 : static_cast<double>(sum.total_ns) / 1e3 / static_cast<double>(sum.calls),
+                                 static_cast<double>(sum.max_ns) / 1e3);
+            }
+            if (!counter_names_.empty()) { s += std::format("{:<32} {:>10}\n", "counter", "value"); }
+            for (size_t id{}; id < counter_names_.size(); ++id) {
+                uint64_t sum{};
+                for (const auto &log : logs_) { sum += log->counters[id].load(std::memory_order_relaxed); }
+                s += std::format("{:<32} {:>10}\n", counter_names_[id], sum);
+            }
+            report_merged(s, "scope", merged_scopes_);
+            report_merged(s, "counter", merged_counters_);
+            for (const auto &log : logs_) {
+                if (log->dropped != 0) { s += std::format("thread {}: {} events not recorded\n", log->tid, log->dropped); }
+            }
+            std::fwrite(s.data(), 1, s.size(), stderr);
+        }
+
+        void dump_json() const {
+            const char *env{std::getenv("EZ_TRACE_FILE")};
+            std::FILE *f{std::fopen(env != nullptr ? env : "trace.json", "w")};
+            if (f == nullptr) { return; }
+
+            // 时间单位为微秒；计数器在末尾以 "C" 事件给出最终值
+            std::string s{"{\"traceEvents\":[\n"};
+            int64_t last_ns{};
+            for (const auto &log : logs_) {
+                for (const auto &e : log->events) {
+                    s += std::format("{{\"name\":\"{}\",\"ph\":\"X\",\"pid\":1,\"tid\":{},\"ts\":{:.3f},\"dur\":{:.3f}}},\n",
+                                     scope_names_[e.id], log->tid, static_cast<double>(e.start_ns) / 1e3,
+                                     static_cast<double>(e.dur_ns) / 1e3);
+                    last_ns = std::max(last_ns, e.start_ns + e.dur_ns);
+                    if (s.size() >= 1 << 20) {
+                        std::fwrite(s.data(), 1, s.size(), f);
+                        s.clear();
+                    }
+                }
+            }
+            for (const auto &log : logs_) {
+                for (size_t id{}; id < counter_names_.size(); ++id) {
+                    s += std::format("{{\"name\":\"{}\",\"ph\":\"C\",\"pid\":1,\"tid\":{},\"ts\":{:.3f},\"args\":{{\"value\":{}}}}},\n",
+                                     counter_names_[id], log->tid, static_cast<double>(last_ns) / 1e3,
+                                     log->counters[id].load(std::memory_order_relaxed));
+                }
+            }
+            if (s.ends_with(",\n")) { s.erase(s.size() - 2, 1); }
+            s += "]}\n";
+            std::fwrite(s.data(), 1, s.size(), f);
+            std::fclose(f);
+        }
+
+      public:
+        Registry() = default;
+        Registry(const Registry &) = delete;
+        auto operator=(const Registry &) -> Registry & = delete;
+
+        ~Registry() {
+            const std::scoped_lock lock{mtx_};
+            dump_text();
+            dump_json();
+        }
+
+        auto scope_id(std::string_view name) -> uint32_t {
+            const std::scoped_lock lock{mtx_};
+            return intern(scope_names_, merged_scopes_, name);
+        }
+
+        auto counter_id(std::string_view name) -> uint32_t {
+            const std::scoped_lock lock{mtx_};
+            return intern(counter_names_, merged_counters_, name);
+        }
+
+        auto attach() -> ThreadLog * {
+            auto log{std::make_unique<ThreadLog>()};
+            const std::scoped_lock lock{mtx_};
+            log->tid = static_cast<uint32_t>(logs_.size());
+            return logs_.emplace_back(std::move(log)).get();
+        }
+
+        [[nodiscard]] auto since_epoch(clock::time_point t) const -> int64_t {
+            return std::chrono::duration_cast<std::chrono::nanoseconds>(t - epoch_).count();
+        }
+    };
+
+    inline auto registry() -> Registry & {
+        static Registry r{};
+        return r;
+    }
+
+    inline auto local() -> ThreadLog & {
+        thread_local ThreadLog *log{registry().attach()};
+        return *log;
+    }
+
+    inline void count(uint32_t id, uint64_t n) {
+        auto &c{local().counters[id]};
+        c.store(c.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+    }
+
+    class Scope {
+        uint32_t id_{};
+        clock::time_point start_{clock::now()};
+
+      public:
+        explicit Scope(uint32_t id) : id_{id} {}
+        Scope(const Scope &) = delete;
+        auto operator=(const Scope &) -> Scope & = delete;
+
+        ~Scope() {
+            const auto end{clock::now()};
+            auto &log{local()};
+            const int64_t dur{std::chrono::duration_cast<std::chrono::nanoseconds>(end - start_).count()};
+            auto &st{log.scopes[id_]};
+            ++st.calls;
+            st.total_ns += dur;
+            st.max_ns = std::max(st.max_ns, dur);
+            if (log.events.size() < max_events) {
+                log.events.push_back({id_, registry().since_epoch(start_), dur});
+            } else {
+                ++log.dropped;
+            }
+        }
+    };
+} // namespace ez::trace
+
+#    define EZ_TRACE_CAT_(a, b) a##b
+#    define EZ_TRACE_CAT(a, b) EZ_TRACE_CAT_(a, b)
+// 名字只在每个调用点第一次执行时登记一次，之后只是数组下标
+#    define EZ_TRACE_SCOPE(name)                                                                          \
+        static const uint32_t EZ_TRACE_CAT(ez_trace_id_, __LINE__){ez::trace::registry().scope_id(name)}; \
+        const ez::trace::Scope EZ_TRACE_CAT(ez_trace_scope_, __LINE__) { EZ_TRACE_CAT(ez_trace_id_, __LINE__) }
+#    define EZ_TRACE_COUNT(name, n)                                                       \
+        do {                                                                              \
+            static const uint32_t ez_trace_id_{ez::trace::registry().counter_id(name)}; \
+            ez::trace::count(ez_trace_id_, static_cast<uint64_t>(n));                     \
+        } while (false)
+
+#else
+
+#    define EZ_TRACE_SCOPE(name) static_cast<void>(0)
+#    define EZ_TRACE_COUNT(name, n) static_cast<void>(0)
+
+#endif
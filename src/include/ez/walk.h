@@ -0,0 +1,103 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdio>
+#include <filesystem>
+#include <format>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+#include "ez/mapped_file.h"
+#include "ez/thread_pool.h"
+
+// 并行遍历目录树：每个目录是工作窃取线程池 TaskPool 中的一个任务
+// 线程先处理自己最近发现的子目录（目录项还在缓存中），空闲时从其他线程窃取较早发现的目录
+namespace ez {
+    namespace fs = std::filesystem;
+
+    namespace detail {
+        template <typename F>
+        void walk_dir(const fs::path &dir, size_t root, F &f, TaskGroup &group, TaskPool &pool) {
+            std::error_code ec{};
+            for (fs::directory_iterator it{dir, fs::directory_options::skip_permission_denied, ec}, end{}; !ec && it != end;
+                 it.increment(ec)) {
+                const auto &entry{*it};
+                std::error_code type_ec{};
+                if (!entry.is_symlink(type_ec) && entry.is_directory(type_ec)) {
+                    group.run([p = entry.path(), root, &f, &group, &pool] { walk_dir(p, root, f, group, pool); });
+                } else {
+                    f(entry, root, pool.index());
+                }
+            }
+        }
+    } // namespace detail
+
+    // 对 roots 下每一个非目录项调用 f(entry, root, thread)，不进入指向目录的符号链接（避免循环），但符号链接本身会交给 f
+    // root 为该项所属的 roots 下标；thread 取 [0, pool.size())，同一线程的调用不会并发，可以按线程汇总而不加锁
+    // 没有权限读取的目录被跳过；roots 中的文件和符号链接（包括指向目录的）直接交给 f
+    template <typename F>
+    void walk(std::span<const fs::path> roots, F &&f, TaskPool &pool = task_pool()) {
+        TaskGroup group{pool};
+        for (size_t i{}; i < roots.size(); ++i) {
+            std::error_code ec{};
+            if (!fs::is_symlink(roots[i], ec) && fs::is_directory(roots[i], ec)) {
+                group.run([&, i] { detail::walk_dir(roots[i], i, f, group, pool); });
+            } else if (const fs::directory_entry entry{roots[i], ec}; !ec && (entry.is_symlink(ec) || entry.exists(ec))) {
+                f(entry, i, pool.index());
+            }
+        }
+        group.wait();
+    }
+
+    // 基准测试比较的线程数：1、2、4……以及硬件线程数
+    inline auto bench_threads() -> std::vector<size_t> {
+        const size_t hw{std::max(1U, std::thread::hardware_concurrency())};
+        std::vector<size_t> v{};
+        for (size_t t{1}; t < hw; t *= 2) { v.push_back(t); }
+        v.push_back(hw);
+        return v;
+    }
+
+    // 基准测试用的目录树：files 个小文本文件，每个目录 1000 个文件，每 100 个目录再分一组
+    // 每 97 个文件中有一个包含 "needle"；已经生成过（有同名的 .complete 标记文件）时直接返回
+    // 全部文件写入成功后才写标记，中途失败的目录树下次重新生成；files 为 0 或写入失败时返回空
+    inline auto make_tree(size_t files) -> std::optional<fs::path> {
+        if (files == 0) { return std::nullopt; }
+        const fs::path root{fs::temp_directory_path() / std::format("ez_tree_{}", files)};
+        const fs::path mark{fs::path{root} += ".complete"};
+        std::error_code ec{};
+        if (fs::exists(mark, ec)) { return root; }
+        fs::remove_all(root, ec);
+        constexpr std::string_view words[]{"alpha", "bravo", "charlie", "delta", "echo", "foxtrot", "golf", "hotel"};
+        std::string text{};
+        for (size_t i{}; i < files; ++i) {
+            const fs::path dir{root / std::format("g{:03}", i / 100'000) / std::format("d{:03}", i / 1000 % 100)};
+            if (i % 1000 == 0) {
+                fs::create_directories(dir, ec);
+                if (ec) { return std::nullopt; }
+            }
+            text.clear();
+            for (size_t line{}; line < 4 + i % 5; ++line) {
+                for (size_t w{}; w < 6; ++w) {
+                    text += words[(i * 31 + line * 7 + w * 3) % std::size(words)];
+                    text += ' ';
+                }
+                if (i % 97 == 0 && line == 2) { text += "needle "; }
+                text += '\n';
+            }
+            std::FILE *f{std::fopen((dir / std::format("f{:06}.txt", i)).string().c_str(), "wb")};
+            if (f == nullptr) { return std::nullopt; }
+            const bool written{std::fwrite(text.data(), 1, text.size(), f) == text.size()};
+            if (std::fclose(f) != 0 || !written) { return std::nullopt; }
+        }
+        std::FILE *f{std::fopen(mark.string().c_str(), "wb")};
+        if (f == nullptr || std::fclose(f) != 0) { return std::nullopt; }
+        return root;
+    }
+} // namespace ez
@@ -29,6 +29,8 @@ set_warnings("allextra")
 set_languages("cxxlatest")
 set_optimize("none")
 
+add_includedirs("src/include")
+
 -- add_cxxflags("-pedantic", {tools = {"clang", "gcc"}})
 -- add_cxxflags("-stdlib=libc++", {tools = "clang"})
 -- add_cxxflags("-stdlib=libc++", {tools = "gcc"})
@@ -68,6 +70,8 @@ target("0107")
 target("0109")
     set_default(false)
     add_files("src/ch01/1.9.cpp")
+    -- libstdc++ 的并行算法基于 TBB
+    if is_plat("linux") then add_syslinks("tbb", "pthread") end
 
 target("0202")
     set_default(false)
@@ -130,6 +134,165 @@ target("0312")
     set_default(false)
     add_files("src/ch03/3.12.cpp")
 
+target("1004")
+    set_default(false)
+    add_files("src/ch10/10.4.cpp")
+
+target("1005")
+    set_default(false)
+    add_files("src/ch10/10.5.cpp")
+
+target("1007")
+    set_default(false)
+    add_files("src/ch10/10.7.cpp")
+
+target("1102")
+    set_default(false)
+    add_files("src/ch11/11.2.cpp")
+
+-- 基准测试目标：始终开启优化，定义 EZ_BENCH 后无需 --bench 参数
+
+target("bench_0102")
+    set_default(false)
+    set_optimize("fastest")
+    add_defines("EZ_BENCH", "NDEBUG")
+    add_files("src/ch01/1.2.cpp")
+
+target("bench_0104")
+    set_default(false)
+    set_optimize("fastest")
+    add_defines("EZ_BENCH", "NDEBUG")
+    add_files("src/ch01/1.4.cpp")
+
+target("bench_0107")
+    set_default(false)
+    set_optimize("fastest")
+    add_defines("EZ_BENCH", "NDEBUG")
+    add_files("src/ch01/1.7.cpp")
+
+target("bench_0109")
+    set_default(false)
+    set_optimize("fastest")
+    add_defines("EZ_BENCH", "NDEBUG")
+    add_files("src/ch01/1.9.cpp")
+    if is_plat("linux") then add_syslinks("tbb", "pthread") end
+
+target("bench_0202")
+    set_default(false)
+    set_optimize("fastest")
+    add_defines("EZ_BENCH", "NDEBUG")
+    add_files("src/ch02/2.2.cpp")
+
+target("bench_0203")
+    set_default(false)
+    set_optimize("fastest")
+    add_defines("EZ_BENCH", "NDEBUG")
+    add_files("src/ch02/2.3.cpp")
+
+target("bench_0303")
+    set_default(false)
+    set_optimize("fastest")
+    add_defines("EZ_BENCH", "NDEBUG")
+    add_files("src/ch03/3.3.cpp")
+
+target("bench_0304")
+    set_default(false)
+    set_optimize("fastest")
+    add_defines("EZ_BENCH", "NDEBUG")
+    add_files("src/ch03/3.4.cpp")
+
+target("bench_0305")
+    set_default(false)
+    set_optimize("fastest")
+    add_defines("EZ_BENCH", "NDEBUG")
+    add_files("src/ch03/3.5.cpp")
+
+target("bench_0306")
+    set_default(false)
+    set_optimize("fastest")
+    add_defines("EZ_BENCH", "NDEBUG")
+    add_files("src/ch03/3.6.cpp")
+
+target("bench_0307")
+    set_default(false)
+    set_optimize("fastest")
+    add_defines("EZ_BENCH", "NDEBUG")
+    add_files("src/ch03/3.7.cpp")
+
+target("bench_0308")
+    set_default(false)
+    set_optimize("fastest")
+    add_defines("EZ_BENCH", "NDEBUG")
+    add_files("src/ch03/3.8.cpp")
+
+target("bench_0309")
+    set_default(false)
+    set_optimize("fastest")
+    add_defines("EZ_BENCH", "NDEBUG")
+    add_files("src/ch03/3.9.cpp")
+
+target("bench_0310")
+    set_default(false)
+    set_optimize("fastest")
+    add_defines("EZ_BENCH", "NDEBUG")
+    add_files("src/ch03/3.10.cpp")
+
+target("bench_0311")
+    set_default(false)
+    set_optimize("fastest")
+    add_defines("EZ_BENCH", "NDEBUG")
+    add_files("src/ch03/3.11.cpp")
+
+target("bench_0312")
+    set_default(false)
+    set_optimize("fastest")
+    add_defines("EZ_BENCH", "NDEBUG")
+    add_files("src/ch03/3.12.cpp")
+
+target("bench_1004")
+    set_default(false)
+    set_optimize("fastest")
+    add_defines("EZ_BENCH", "NDEBUG")
+    add_files("src/ch10/10.4.cpp")
+
+target("bench_1005")
+    set_default(false)
+    set_optimize("fastest")
+    add_defines("EZ_BENCH", "NDEBUG")
+    add_files("src/ch10/10.5.cpp")
+
+target("bench_1007")
+    set_default(false)
+    set_optimize("fastest")
+    add_defines("EZ_BENCH", "NDEBUG")
+    add_files("src/ch10/10.7.cpp")
+
+target("bench_1102")
+    set_default(false)
+    set_optimize("fastest")
+    add_defines("EZ_BENCH", "NDEBUG")
+    add_files("src/ch11/11.2.cpp")
+
+-- 插桩目标：定义 EZ_TRACE，退出时输出各阶段耗时统计和 trace.json
+
+target("trace_0310")
+    set_default(false)
+    set_optimize("fastest")
+    add_defines("EZ_TRACE", "NDEBUG")
+    add_files("src/ch03/3.10.cpp")
+
+target("trace_0311")
+    set_default(false)
+    set_optimize("fastest")
+    add_defines("EZ_TRACE", "NDEBUG")
+    add_files("src/ch03/3.11.cpp")
+
+target("trace_0312")
+    set_default(false)
+    set_optimize("fastest")
+    add_defines("EZ_TRACE", "NDEBUG")
+    add_files("src/ch03/3.12.cpp")
+
 
 
 